@@ -0,0 +1,83 @@
+#pragma once
+
+#include <PluginProcessor.h>
+
+//==============================================================================
+/**
+    A prepared processor plus the buffers a host would hand it.
+
+    The input is kept in a separate buffer and copied in before every block, so
+    each block sees the same signal however many iterations run. With double
+    precision the processor is handed 64-bit buffers, as a 64-bit host would.
+*/
+class BenchmarkInstance
+{
+public:
+    BenchmarkInstance (double sampleRate, int blockSize,
+                       const juce::AudioChannelSet& layout = juce::AudioChannelSet::create5point1(),
+                       juce::AudioProcessor::ProcessingPrecision precision = juce::AudioProcessor::singlePrecision,
+                       int numSubwoofers = 0)
+    {
+        auto supported = processor.setBusesLayout (BassicManagerAudioProcessor::makeBusesLayout (layout, numSubwoofers));
+        jassert (supported);
+        juce::ignoreUnused (supported);
+
+        processor.setProcessingPrecision (precision);
+        processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor.prepareToPlay (sampleRate, blockSize);
+
+        auto numChannels = juce::jmax (processor.getTotalNumInputChannels(), processor.getTotalNumOutputChannels());
+        input.setSize (numChannels, blockSize);
+        buffer.setSize (numChannels, blockSize);
+        input.clear();
+
+        if (precision == juce::AudioProcessor::doublePrecision)
+            doubleBuffer.setSize (numChannels, blockSize);
+    }
+
+    /** Fills every channel with full-scale noise. */
+    void fillFullScale()
+    {
+        juce::Random random (0x5eed);
+
+        for (int ch = 0; ch < input.getNumChannels(); ++ch)
+            for (int i = 0; i < input.getNumSamples(); ++i)
+                input.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    juce::RangedAudioParameter* getParameter (const juce::String& parameterID)
+    {
+        for (auto* parameter : processor.getParameters())
+            if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+                if (ranged->paramID == parameterID)
+                    return ranged;
+
+        jassertfalse;
+        return nullptr;
+    }
+
+    void processBlock()
+    {
+        if (processor.isUsingDoublePrecision())
+        {
+            for (int ch = 0; ch < doubleBuffer.getNumChannels(); ++ch)
+                std::copy (input.getReadPointer (ch), input.getReadPointer (ch) + input.getNumSamples(),
+                           doubleBuffer.getWritePointer (ch));
+
+            processor.processBlock (doubleBuffer, midi);
+            return;
+        }
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            buffer.copyFrom (ch, 0, input, ch, 0, input.getNumSamples());
+
+        processor.processBlock (buffer, midi);
+    }
+
+    BassicManagerAudioProcessor processor;
+
+private:
+    juce::AudioBuffer<float> input, buffer;
+    juce::AudioBuffer<double> doubleBuffer;
+    juce::MidiBuffer midi;
+};
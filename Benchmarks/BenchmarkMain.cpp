@@ -0,0 +1,18 @@
+#include <benchmark/benchmark.h>
+#include <juce_events/juce_events.h>
+
+// Like BENCHMARK_MAIN(), but with JUCE initialised for the processor's value tree
+
+int main (int argc, char** argv)
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    benchmark::Initialize (&argc, argv);
+
+    if (benchmark::ReportUnrecognizedArguments (argc, argv))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
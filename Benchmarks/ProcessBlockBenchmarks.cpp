@@ -0,0 +1,260 @@
+/*
+  ==============================================================================
+
+    processBlock throughput across block sizes, sample rates, automation,
+    input level and surround layout.
+
+    Run with --benchmark_out=results.json --benchmark_out_format=json to keep
+    results for comparing builds.
+
+  ==============================================================================
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+
+//==============================================================================
+enum class Automation { staticParameters, automated };
+enum class Input { silent, fullScale };
+
+/*  Sets the counter every benchmark here but the layout one reports, for
+    samplesPerIteration sample frames per iteration, and counts those frames as
+    the items processed.
+
+    Counters:
+        ns_per_sample         processing time per sample frame (all channels)
+*/
+static void setNanosecondsPerSample (benchmark::State& state, int samplesPerIteration)
+{
+    state.SetItemsProcessed (state.iterations() * samplesPerIteration);
+    state.counters["ns_per_sample"] = benchmark::Counter (samplesPerIteration * 1.0e-9,
+                                                          benchmark::Counter::kIsIterationInvariantRate
+                                                              | benchmark::Counter::kInvert);
+}
+
+//==============================================================================
+/*  Arguments: block size, sample rate, Automation, Input
+
+    Counters:
+        realtime_instances    how many instances one core could run in real time
+*/
+static void BM_ProcessBlock (benchmark::State& state)
+{
+    auto blockSize = (int) state.range (0);
+    auto sampleRate = (double) state.range (1);
+    auto automation = (Automation) state.range (2);
+    auto input = (Input) state.range (3);
+
+    BenchmarkInstance instance (sampleRate, blockSize);
+
+    if (input == Input::fullScale)
+        instance.fillFullScale();
+
+    // Sweep the crossover across its range once per second of audio, as a host
+    // writing automation every block would
+    auto* crossover = instance.getParameter ("crossoverFrequency");
+    auto sweepIncrement = (float) (blockSize / sampleRate);
+    float sweep = 0.0f;
+
+    for (auto _ : state)
+    {
+        if (automation == Automation::automated)
+        {
+            sweep += sweepIncrement;
+
+            if (sweep >= 1.0f)
+                sweep -= 1.0f;
+
+            crossover->setValueNotifyingHost (sweep);
+        }
+
+        instance.processBlock();
+    }
+
+    setNanosecondsPerSample (state, blockSize);
+    state.counters["realtime_instances"] = benchmark::Counter (blockSize / sampleRate,
+                                                               benchmark::Counter::kIsIterationInvariantRate);
+}
+
+BENCHMARK (BM_ProcessBlock)
+    ->ArgNames ({ "block", "rate", "automated", "fullScale" })
+    ->ArgsProduct ({ benchmark::CreateRange (16, 4096, 2),
+                     { 44100, 48000, 96000, 192000 },
+                     { (int) Automation::staticParameters, (int) Automation::automated },
+                     { (int) Input::silent, (int) Input::fullScale } });
+
+//==============================================================================
+/*  Arguments: index into BassManagementChannelMap::getSupportedLayouts()
+
+    Counters:
+        ns_per_channel_sample    processing time per sample of one channel, which
+                                 should stay flat as the layout grows
+*/
+static void BM_ProcessBlockLayout (benchmark::State& state)
+{
+    auto layout = BassManagementChannelMap::getSupportedLayouts()[(int) state.range (0)];
+    auto blockSize = 512;
+
+    BenchmarkInstance instance (48000.0, blockSize, layout);
+    instance.fillFullScale();
+
+    for (auto _ : state)
+        instance.processBlock();
+
+    state.SetLabel (layout.getDescription().toStdString());
+    state.SetItemsProcessed (state.iterations() * blockSize * layout.size());
+    state.counters["ns_per_channel_sample"] = benchmark::Counter (blockSize * layout.size() * 1.0e-9,
+                                                                  benchmark::Counter::kIsIterationInvariantRate
+                                                                      | benchmark::Counter::kInvert);
+}
+
+BENCHMARK (BM_ProcessBlockLayout)
+    ->ArgName ("layout")
+    ->DenseRange (0, BassManagementChannelMap::getSupportedLayouts().size() - 1);
+
+//==============================================================================
+/*  Arguments: sample rate, crossover topology index, 1 for double precision
+
+    The time per sample includes the copy into the host's buffer type.
+*/
+static void BM_ProcessBlockPrecision (benchmark::State& state)
+{
+    auto sampleRate = (double) state.range (0);
+    auto precision = state.range (2) != 0 ? juce::AudioProcessor::doublePrecision
+                                          : juce::AudioProcessor::singlePrecision;
+    auto blockSize = 512;
+
+    BenchmarkInstance instance (sampleRate, blockSize, juce::AudioChannelSet::create5point1(), precision);
+    instance.getParameter ("crossoverTopology")->setValueNotifyingHost ((float) state.range (1) / 2.0f);
+    instance.fillFullScale();
+
+    for (auto _ : state)
+        instance.processBlock();
+
+    setNanosecondsPerSample (state, blockSize);
+}
+
+BENCHMARK (BM_ProcessBlockPrecision)
+    ->ArgNames ({ "rate", "topology", "double" })
+    ->ArgsProduct ({ { 48000, 192000 }, { 0, 1, 2 }, { 0, 1 } });
+
+//==============================================================================
+/*  Arguments: crossover slope index, 1 for automated crossover frequency */
+static void BM_ProcessBlockSlope (benchmark::State& state)
+{
+    auto blockSize = 512;
+
+    BenchmarkInstance instance (48000.0, blockSize, juce::AudioChannelSet::create5point1());
+    auto* slope = instance.getParameter ("crossoverSlope");
+    auto* crossover = instance.getParameter ("crossoverFrequency");
+    slope->setValueNotifyingHost (slope->convertTo0to1 ((float) state.range (0)));
+    instance.fillFullScale();
+
+    auto automated = state.range (1) != 0;
+    auto sweep = 0.0f;
+
+    for (auto _ : state)
+    {
+        if (automated)
+        {
+            sweep = sweep < 1.0f ? sweep + 0.01f : 0.0f;
+            crossover->setValueNotifyingHost (sweep);
+        }
+
+        instance.processBlock();
+    }
+
+    setNanosecondsPerSample (state, blockSize);
+}
+
+BENCHMARK (BM_ProcessBlockSlope)
+    ->ArgNames ({ "slope", "automated" })
+    ->ArgsProduct ({ benchmark::CreateDenseRange (0, numCrossoverSlopes - 1, 1), { 0, 1 } });
+
+//==============================================================================
+/*  Arguments: number of subwoofer feeds (0 switches the bus off) */
+static void BM_ProcessBlockSubwoofers (benchmark::State& state)
+{
+    auto blockSize = 512;
+    auto numSubwoofers = (int) state.range (0);
+
+    BenchmarkInstance instance (48000.0, blockSize, juce::AudioChannelSet::create7point1(),
+                                juce::AudioProcessor::singlePrecision, numSubwoofers);
+
+    // Every feed tuned differently, so none of the lanes share their coefficients
+    for (int sub = 1; sub <= numSubwoofers; ++sub)
+    {
+        auto* lowPass = instance.getParameter ("subwooferLowPass" + juce::String (sub));
+        auto* delay = instance.getParameter ("subwooferDelay" + juce::String (sub));
+        lowPass->setValueNotifyingHost (lowPass->convertTo0to1 (60.0f + 20.0f * (float) sub));
+        delay->setValueNotifyingHost (delay->convertTo0to1 (1.5f * (float) sub));
+    }
+
+    instance.fillFullScale();
+
+    for (auto _ : state)
+        instance.processBlock();
+
+    setNanosecondsPerSample (state, blockSize);
+}
+
+BENCHMARK (BM_ProcessBlockSubwoofers)
+    ->ArgName ("subwoofers")
+    ->DenseRange (0, BassManagementChannelMap::maxSubwoofers);
+
+//==============================================================================
+/*  Arguments: LFE limiter off or on, number of subwoofer feeds
+
+    Full-scale input with the LFE boosted, so the limiter is always reducing gain.
+*/
+static void BM_ProcessBlockLimiter (benchmark::State& state)
+{
+    auto blockSize = 512;
+    auto numSubwoofers = (int) state.range (1);
+
+    BenchmarkInstance instance (48000.0, blockSize, juce::AudioChannelSet::create7point1(),
+                                juce::AudioProcessor::singlePrecision, numSubwoofers);
+
+    instance.getParameter ("lfeLimiter")->setValueNotifyingHost ((float) state.range (0));
+    instance.getParameter ("lfeBoost")->setValueNotifyingHost (1.0f);
+    instance.fillFullScale();
+
+    for (auto _ : state)
+        instance.processBlock();
+
+    setNanosecondsPerSample (state, blockSize);
+}
+
+BENCHMARK (BM_ProcessBlockLimiter)
+    ->ArgNames ({ "limiter", "subwoofers" })
+    ->ArgsProduct ({ { 0, 1 }, { 0, BassManagementChannelMap::maxSubwoofers } });
+
+//==============================================================================
+/*  Arguments: parallel channel groups off or on, block size
+
+    9.1.6 at full scale, the widest layout, with the crossover held still so long
+    enough blocks go to the workers. The time per sample is wall-clock time, as
+    the host's audio thread sees it.
+*/
+static void BM_ProcessBlockParallel (benchmark::State& state)
+{
+    auto blockSize = (int) state.range (1);
+
+    BenchmarkInstance instance (48000.0, blockSize, juce::AudioChannelSet::create9point1point6());
+
+    // The workers are started when the host prepares
+    instance.getParameter ("parallelChannels")->setValueNotifyingHost ((float) state.range (0));
+    instance.processor.prepareToPlay (48000.0, blockSize);
+    instance.fillFullScale();
+
+    for (auto _ : state)
+        instance.processBlock();
+
+    setNanosecondsPerSample (state, blockSize);
+}
+
+BENCHMARK (BM_ProcessBlockParallel)
+    ->ArgNames ({ "parallel", "block" })
+    ->ArgsProduct ({ { 0, 1 }, benchmark::CreateRange (64, 4096, 2) })
+    ->UseRealTime();
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    Instance startup: opening a session of many instances, and switching all of
+    their sample rates at once.
+
+  ==============================================================================
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+
+//==============================================================================
+/*  Arguments: number of instances
+
+    Creates and prepares a session's worth of instances, then destroys them, so
+    every iteration starts with no crossover tables designed.
+
+    Counters:
+        us_per_instance       time to create and prepare one instance
+*/
+static void BM_SessionOpen (benchmark::State& state)
+{
+    auto numInstances = (int) state.range (0);
+
+    for (auto _ : state)
+    {
+        std::vector<std::unique_ptr<BassicManagerAudioProcessor>> session;
+
+        for (int i = 0; i < numInstances; ++i)
+        {
+            session.push_back (std::make_unique<BassicManagerAudioProcessor>());
+            session.back()->prepareToPlay (48000.0, 512);
+        }
+
+        state.PauseTiming();
+        session.clear();
+        state.ResumeTiming();
+    }
+
+    state.counters["us_per_instance"] = benchmark::Counter (numInstances * 1.0e-6,
+                                                            benchmark::Counter::kIsIterationInvariantRate
+                                                                | benchmark::Counter::kInvert);
+}
+
+BENCHMARK (BM_SessionOpen)->ArgName ("instances")->RangeMultiplier (4)->Range (1, 256)->Unit (benchmark::kMillisecond);
+
+//==============================================================================
+/*  Arguments: number of instances
+
+    Moves every instance of a session between 44.1 and 48 kHz, as a host does
+    when the interface's rate changes.
+
+    Counters:
+        us_per_instance       time to prepare one instance at the new rate
+*/
+static void BM_SampleRateSwitch (benchmark::State& state)
+{
+    auto numInstances = (int) state.range (0);
+    std::vector<std::unique_ptr<BenchmarkInstance>> session;
+
+    for (int i = 0; i < numInstances; ++i)
+        session.push_back (std::make_unique<BenchmarkInstance> (48000.0, 512));
+
+    auto sampleRate = 48000.0;
+
+    for (auto _ : state)
+    {
+        sampleRate = sampleRate == 48000.0 ? 44100.0 : 48000.0;
+
+        for (auto& instance : session)
+            instance->processor.prepareToPlay (sampleRate, 512);
+    }
+
+    state.counters["us_per_instance"] = benchmark::Counter (numInstances * 1.0e-6,
+                                                            benchmark::Counter::kIsIterationInvariantRate
+                                                                | benchmark::Counter::kInvert);
+}
+
+BENCHMARK (BM_SampleRateSwitch)->ArgName ("instances")->RangeMultiplier (4)->Range (1, 256)->Unit (benchmark::kMillisecond);
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    Session save and recall: the binary state against the XML one it replaced.
+
+  ==============================================================================
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkHelpers.h"
+
+namespace
+{
+    enum StateFormat { binaryState, xmlState };
+
+    /** The state of a processor with a few parameters moved, in either format. */
+    juce::MemoryBlock getState (BassicManagerAudioProcessor& processor, StateFormat format)
+    {
+        juce::MemoryBlock state;
+
+        if (format == binaryState)
+            processor.getStateInformation (state);
+        else
+            juce::AudioProcessor::copyXmlToBinary (*processor.getValueTreeState().copyState().createXml(), state);
+
+        return state;
+    }
+}
+
+//==============================================================================
+/*  Arguments: 0 for the binary state, 1 for XML
+
+    Counters:
+        bytes                 size of the saved state
+*/
+static void BM_StateSave (benchmark::State& state)
+{
+    BenchmarkInstance instance (48000.0, 512);
+    auto format = (StateFormat) state.range (0);
+    juce::MemoryBlock saved;
+
+    for (auto _ : state)
+    {
+        saved = getState (instance.processor, format);
+        benchmark::DoNotOptimize (saved.getData());
+    }
+
+    state.counters["bytes"] = (double) saved.getSize();
+}
+
+BENCHMARK (BM_StateSave)->ArgName ("xml")->DenseRange (0, 1);
+
+//==============================================================================
+/*  Arguments: 0 for the binary state, 1 for XML
+
+    Alternates between two states, so every recall really moves the parameters.
+*/
+static void BM_StateRecall (benchmark::State& state)
+{
+    BenchmarkInstance instance (48000.0, 512);
+    auto format = (StateFormat) state.range (0);
+
+    auto defaults = getState (instance.processor, format);
+
+    for (auto* id : { "crossoverFrequency", "channelDelay2", "channelTrim5", "subwooferLowPass1" })
+    {
+        auto* parameter = instance.getParameter (id);
+        parameter->setValueNotifyingHost (0.75f);
+    }
+
+    auto session = getState (instance.processor, format);
+    auto recallSession = true;
+
+    for (auto _ : state)
+    {
+        auto& recalled = recallSession ? session : defaults;
+        instance.processor.setStateInformation (recalled.getData(), (int) recalled.getSize());
+        recallSession = ! recallSession;
+    }
+}
+
+BENCHMARK (BM_StateRecall)->ArgName ("xml")->DenseRange (0, 1);
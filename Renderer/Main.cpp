@@ -0,0 +1,326 @@
+/*
+  ==============================================================================
+
+    Headless batch renderer: runs BassicManagerAudioProcessor over multichannel
+    WAV/AIFF files without a host.
+
+    Usage:
+        BassicManagerRender [--state plugin-state] [--jobs N] [--block N]
+                            [--trace trace.json] --output-dir <dir> <input files...>
+
+    --state takes the plugin's state as a session stores it, either the
+    binary state the plugin saves or the XML earlier versions saved.
+
+    --trace writes a Chrome/Perfetto trace of every processBlock stage, with
+    one track per worker.
+
+  ==============================================================================
+*/
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_utils/juce_audio_utils.h>
+
+#include <iostream>
+
+#include "PluginProcessor.h"
+
+//==============================================================================
+struct RenderSettings
+{
+    juce::MemoryBlock state;            // plugin state, as getStateInformation would produce it
+    juce::File outputDirectory;
+    juce::File traceFile;               // no trace unless set
+    int blockSize = 32768;
+};
+
+//==============================================================================
+/** Moves the profiler's queued spans into events, so its FIFO never fills up. */
+static void collectTraceEvents (BassicManagerAudioProcessor& processor, std::vector<ProcessingProfiler::Event>& events)
+{
+    ProcessingProfiler::Event chunk[256];
+
+    while (auto numRead = processor.getProfiler().readEvents (chunk, (int) std::size (chunk)))
+        events.insert (events.end(), chunk, chunk + numRead);
+}
+
+//==============================================================================
+/**
+    Renders one file: streams it from disk in blockSize chunks, runs the processor
+    and writes the result in the same format and bit depth as the input.
+*/
+static juce::Result renderFile (BassicManagerAudioProcessor& processor,
+                                juce::AudioFormatManager& formatManager,
+                                const juce::File& input,
+                                const RenderSettings& settings,
+                                std::vector<ProcessingProfiler::Event>& traceEvents)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (input));
+
+    if (reader == nullptr)
+        return juce::Result::fail ("can't read " + input.getFullPathName());
+
+    auto numChannels = (int) reader->numChannels;
+
+    // Use the layout stored in the file when it's one we support, otherwise go by channel count
+    auto layout = reader->getChannelLayout();
+
+    if (! BassManagementChannelMap::isSupported (layout))
+        layout = BassManagementChannelMap::getDefaultLayout (numChannels);
+
+    if (layout.isDisabled() || ! processor.setBusesLayout (BassicManagerAudioProcessor::makeBusesLayout (layout)))
+        return juce::Result::fail (input.getFileName() + " has " + juce::String (numChannels)
+                                   + " channels, which isn't a supported surround layout");
+
+    auto output = settings.outputDirectory.getChildFile (input.getFileName());
+    output.deleteFile();
+
+    auto* format = formatManager.findFormatForFileExtension (input.getFileExtension());
+    std::unique_ptr<juce::FileOutputStream> stream (output.createOutputStream());
+
+    if (format == nullptr || stream == nullptr)
+        return juce::Result::fail ("can't write " + output.getFullPathName());
+
+    std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(),
+                                                                              reader->sampleRate,
+                                                                              reader->getChannelLayout(),
+                                                                              (int) reader->bitsPerSample,
+                                                                              reader->metadataValues,
+                                                                              0));
+
+    if (writer == nullptr)
+        return juce::Result::fail ("can't create a writer for " + output.getFullPathName());
+
+    stream.release(); // the writer owns it now
+
+    // Every file starts from a freshly prepared processor with the requested state
+    if (! settings.state.isEmpty())
+        processor.setStateInformation (settings.state.getData(), (int) settings.state.getSize());
+
+    processor.setNonRealtime (true);
+    processor.setRateAndBufferSizeDetails (reader->sampleRate, settings.blockSize);
+    processor.prepareToPlay (reader->sampleRate, settings.blockSize);
+
+    // Drop the first `latency` output samples and flush the same amount of silence
+    // through at the end, so the output lines up with the input sample for sample
+    auto latency = (juce::int64) processor.getLatencySamples();
+    auto length = reader->lengthInSamples;
+
+    juce::AudioBuffer<float> buffer (numChannels, settings.blockSize);
+    juce::MidiBuffer midi;
+
+    for (juce::int64 position = 0; position < length + latency; position += settings.blockSize)
+    {
+        auto numSamples = (int) juce::jmin ((juce::int64) settings.blockSize, length + latency - position);
+        auto numToRead = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, length - position);
+
+        buffer.clear();
+        reader->read (&buffer, 0, numToRead, position, true, true);
+
+        processor.processBlock (buffer, midi);
+
+        if (settings.traceFile != juce::File())
+            collectTraceEvents (processor, traceEvents);
+
+        auto skip = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, latency - position);
+
+        if (skip < numSamples && ! writer->writeFromAudioSampleBuffer (buffer, skip, numSamples - skip))
+            return juce::Result::fail ("write failed for " + output.getFullPathName());
+    }
+
+    processor.releaseResources();
+    return juce::Result::ok();
+}
+
+//==============================================================================
+/**
+    A worker owns one processor instance and keeps taking the next unclaimed file
+    until the list is exhausted.
+*/
+class RenderWorker  : public juce::Thread
+{
+public:
+    RenderWorker (const juce::Array<juce::File>& filesToRender,
+                  std::atomic<int>& sharedNextFile,
+                  const RenderSettings& renderSettings)
+        : juce::Thread ("Render worker"),
+          files (filesToRender),
+          nextFile (sharedNextFile),
+          settings (renderSettings)
+    {
+        formatManager.registerBasicFormats();
+    }
+
+    void run() override
+    {
+        BassicManagerAudioProcessor processor;
+        processor.getProfiler().setTraceEnabled (settings.traceFile != juce::File());
+
+        for (auto index = nextFile++; index < files.size() && ! threadShouldExit(); index = nextFile++)
+        {
+            auto& file = files.getReference (index);
+            auto start = juce::Time::getMillisecondCounterHiRes();
+            auto result = renderFile (processor, formatManager, file, settings, traceEvents);
+            auto seconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+            const juce::ScopedLock sl (outputLock());
+
+            if (result.failed())
+            {
+                std::cerr << "FAILED " << result.getErrorMessage() << std::endl;
+                ++numFailures;
+            }
+            else
+            {
+                std::cout << file.getFileName() << "  " << juce::String (seconds, 2) << " s  "
+                          << juce::String (100.0 * processor.getSilenceSkipRate(), 1) << "% silent skipped" << std::endl;
+            }
+        }
+    }
+
+    int getNumFailures() const noexcept     { return numFailures; }
+
+    const std::vector<ProcessingProfiler::Event>& getTraceEvents() const noexcept   { return traceEvents; }
+
+private:
+    static juce::CriticalSection& outputLock()
+    {
+        static juce::CriticalSection lock;
+        return lock;
+    }
+
+    const juce::Array<juce::File>& files;
+    std::atomic<int>& nextFile;
+    const RenderSettings& settings;
+    juce::AudioFormatManager formatManager;
+    std::vector<ProcessingProfiler::Event> traceEvents;
+    int numFailures = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderWorker)
+};
+
+//==============================================================================
+static void printUsage()
+{
+    std::cout << "Usage: BassicManagerRender [--state plugin-state] [--jobs N] [--block N]" << std::endl
+              << "                           [--trace trace.json] --output-dir <dir> <input files...>" << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    RenderSettings settings;
+    auto numJobs = juce::SystemStats::getNumCpus();
+    juce::Array<juce::File> files;
+
+    for (int i = 0; i < args.size(); ++i)
+    {
+        auto arg = args[i];
+
+        if (arg == "--state" && i + 1 < args.size())
+        {
+            // The binary state the plugin stores in a session is passed on as it is,
+            // and anything else is read as the XML state of earlier versions
+            auto stateFile = args[++i].resolveAsFile();
+            juce::MemoryBlock data;
+
+            if (! stateFile.loadFileAsData (data))
+            {
+                std::cerr << "Can't read state file " << args[i].text << std::endl;
+                return 1;
+            }
+
+            if (BinaryParameterState::isBinaryState (data.getData(), (int) data.getSize()))
+            {
+                settings.state = std::move (data);
+            }
+            else
+            {
+                auto xml = juce::parseXML (data.toString());
+
+                if (xml == nullptr)
+                {
+                    std::cerr << "Can't parse state file " << args[i].text << std::endl;
+                    return 1;
+                }
+
+                juce::AudioProcessor::copyXmlToBinary (*xml, settings.state);
+            }
+        }
+        else if (arg == "--jobs" && i + 1 < args.size())
+        {
+            numJobs = juce::jmax (1, args[++i].text.getIntValue());
+        }
+        else if (arg == "--block" && i + 1 < args.size())
+        {
+            settings.blockSize = juce::jmax (16, args[++i].text.getIntValue());
+        }
+        else if (arg == "--trace" && i + 1 < args.size())
+        {
+            settings.traceFile = args[++i].resolveAsFile();
+        }
+        else if (arg == "--output-dir" && i + 1 < args.size())
+        {
+            settings.outputDirectory = args[++i].resolveAsFile();
+        }
+        else if (arg.isOption())
+        {
+            printUsage();
+            return 1;
+        }
+        else
+        {
+            files.add (arg.resolveAsFile());
+        }
+    }
+
+    if (files.isEmpty() || settings.outputDirectory == juce::File())
+    {
+        printUsage();
+        return 1;
+    }
+
+    if (! settings.outputDirectory.createDirectory())
+    {
+        std::cerr << "Can't create " << settings.outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    std::atomic<int> nextFile { 0 };
+    juce::OwnedArray<RenderWorker> workers;
+
+    for (int i = 0; i < juce::jmin (numJobs, files.size()); ++i)
+        workers.add (new RenderWorker (files, nextFile, settings))->startThread();
+
+    int numFailures = 0;
+
+    for (auto* worker : workers)
+    {
+        worker->waitForThreadToExit (-1);
+        numFailures += worker->getNumFailures();
+    }
+
+    if (settings.traceFile != juce::File())
+    {
+        settings.traceFile.deleteFile();
+        juce::FileOutputStream stream (settings.traceFile);
+
+        if (! stream.openedOk())
+        {
+            std::cerr << "Can't write " << settings.traceFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        ChromeTraceWriter trace (stream);
+
+        for (int i = 0; i < workers.size(); ++i)
+        {
+            auto& events = workers[i]->getTraceEvents();
+            trace.addThreadName (i + 1, "Render worker " + juce::String (i + 1));
+            trace.addEvents (events.data(), (int) events.size(), i + 1);
+        }
+    }
+
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,989 @@
+/*
+  ==============================================================================
+
+    The bass-management DSP, for either sample type.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "ChannelMap.h"
+#include "CoefficientTable.h"
+#include "LinearPhaseCrossover.h"
+#include "LookAheadLimiter.h"
+#include "MeterSource.h"
+#include "MultichannelBiquad.h"
+#include "MultirateFilter.h"
+#include "ParameterSnapshot.h"
+#include "ProcessingProfiler.h"
+#include "RealtimeWorkerPool.h"
+#include "SilenceDetector.h"
+#include "SpeakerAlignment.h"
+#include "SubwooferBank.h"
+#include "StateVariableFilters.h"
+
+//==============================================================================
+/**
+    Everything processBlock does to the audio, templated on the sample type so
+    the processor can offer hosts a double-precision path without converting.
+
+    Both instantiations share the same filter classes, channel kernels and SIMD
+    lane packing; only juce::dsp::SIMDRegister's width differs (twice as many
+    float lanes as double lanes). The linear-phase crossover is the exception:
+    its convolutions always run in float because juce::dsp::FFT does.
+
+    The engine owns all the filter state, but not the profiler or the meter
+    source, which are shared by both instantiations and outlive them.
+*/
+template <typename SampleType>
+class BassManagementEngine
+{
+public:
+    using Parameters = BassManagementParameters;
+
+    static constexpr int numHighPassSections = 8;
+
+    // process() works through the host buffer in tiles of this many samples, aligned
+    // to the start of the stream rather than of the host block. A tile of every
+    // channel plus the filter scratch buffers stays in cache, and smoothed
+    // coefficients are updated at tile boundaries, so automation lands on the same
+    // samples whatever block size the host uses
+    static constexpr int tileSize = 64;
+
+    BassManagementEngine (ProcessingProfiler& profilerToUse, MeterSource& meterSourceToUse)
+        : profiler (profilerToUse), meterSource (meterSourceToUse)
+    {
+    }
+
+    //==============================================================================
+    /** Allocates and designs everything for a layout and rate. Not for the audio thread.
+
+        numSubwoofers feeds follow the layout's channels in the buffer, each a copy of
+        the LFE output with its own low-pass, gain, polarity and delay.
+    */
+    void prepare (double newSampleRate, const juce::AudioChannelSet& layout, int numSubwoofers, const Parameters& parameters)
+    {
+        sampleRate = newSampleRate;
+
+        // Nothing ever processes more than one tile at a time, whatever the host block size
+        juce::dsp::ProcessSpec lowPassSpec { sampleRate, (juce::uint32) tileSize, 1 };
+
+        // Everything that depends on the number of mains follows the negotiated layout
+        channelMap = BassManagementChannelMap::fromChannelSet (layout);
+        sumMainChannels = channelMap.template getSumFunction<SampleType>();
+        auto numMainChannels = channelMap.numMains;
+
+        // All high-pass designs happen here, the audio thread only looks them up. Other
+        // instances at this rate have usually designed the table already
+        if (coefficientTable == nullptr || coefficientTable->getSampleRate() != sampleRate)
+            coefficientTable = Table::getShared (sampleRate);
+
+        // Satellite speaker high-passes, one state block per channel group. Room for the
+        // steepest slope is made now, so switching slopes never allocates
+        numChannelGroups = (numMainChannels + channelGroupSize - 1) / channelGroupSize;
+
+        for (int group = 0; group < numChannelGroups; ++group)
+            mainHighPass[(size_t) group].prepare (juce::jmin (channelGroupSize, numMainChannels - group * channelGroupSize),
+                                                  Table::maximumNumSections, tileSize);
+
+        sumLowPass.prepare (sampleRate);
+        lfeLowPassFilter.prepare (lowPassSpec);
+
+        // A tile, or a whole stretch when the groups run in parallel
+        sumBuffer.setSize (1, maximumParallelSamples);
+
+        // The workers are only started here, so switching the mode on mid-stream has
+        // to wait for the next prepare before the groups can spread out. A worker
+        // sharing a core with the audio thread would only hold it up at the barrier
+        parallelEnabled = parameters.parallelChannels;
+        auto numWorkers = RealtimeWorkerPool::getUsefulNumWorkers (numChannelGroups);
+
+        if (parallelEnabled && numWorkers > 0)
+            workers.start (numWorkers);
+        else
+            workers.stop();
+
+        // Multi-rate bass path, prepared even when disabled so it can be switched on mid-stream
+        auto numStages = getNumHalfBandStages (sampleRate, multirateMinimumRate);
+        auto factor = 1 << numStages;
+        auto multirateBlockSize = tileSize / factor + 1;
+        juce::dsp::ProcessSpec multirateSpec { sampleRate / factor, (juce::uint32) multirateBlockSize, 1 };
+
+        sumDecimator.prepare (sampleRate, numStages, multiratePassband);
+        lfeDecimator.prepare (sampleRate, numStages, multiratePassband);
+        bassInterpolator.prepare (sampleRate, numStages, multiratePassband, tileSize);
+        multirateSumLowPass.prepare (sampleRate / factor);
+        multirateLfeLowPassFilter.prepare (multirateSpec);
+        multirateBuffer.setSize (2, multirateBlockSize);
+
+        mainsDelay.setMaximumDelayInSamples (juce::jmax (1, bassInterpolator.getLatencyInSamples() + sumDecimator.getLatencyInSamples()));
+        mainsDelay.prepare ({ sampleRate, (juce::uint32) tileSize, (juce::uint32) numMainChannels });
+
+        stateVariableHighPass.prepare (sampleRate, numMainChannels, numHighPassSections, tileSize, cutoffRampSeconds);
+        stateVariableSumLowPass.prepare (sampleRate, cutoffRampSeconds);
+        stateVariableLfeLowPass.prepare (sampleRate, cutoffRampSeconds);
+        multirateStateVariableSumLowPass.prepare (sampleRate / factor, cutoffRampSeconds);
+        multirateStateVariableLfeLowPass.prepare (sampleRate / factor, cutoffRampSeconds);
+
+        linearPhaseCrossover.prepare (sampleRate, numMainChannels, tileSize);
+
+        firstSubwooferChannel = layout.size();
+        numSubwoofers = juce::jmin (numSubwoofers, BassManagementChannelMap::maxSubwoofers);
+
+        // The limiter delays the LFE and every subwoofer feed, so the other channels'
+        // distance delays get room to wait for them
+        limiter.prepare (sampleRate, 1 + numSubwoofers);
+        speakerAlignment.prepare (sampleRate, juce::jmin (layout.size(), BassManagementChannelMap::maxChannels), tileSize,
+                                  limiter.getLatencyInSamples());
+
+        subwooferBank.prepare (sampleRate, numSubwoofers, tileSize);
+        subwooferAlignment.prepare (sampleRate, numSubwoofers, tileSize);
+
+        mainsSilence.prepare (numMainChannels, mainsDelay.getMaximumDelayInSamples() + juce::roundToInt (sampleRate / Table::minimumFrequency));
+        bassSilence.prepare (1, juce::roundToInt (sampleRate * bassTailSeconds));
+
+        crossoverFrequency.reset (sampleRate, cutoffRampSeconds);
+        lfeLowPassFrequency.reset (sampleRate, cutoffRampSeconds);
+        crossoverFrequency.setCurrentAndTargetValue ((SampleType) parameters.crossoverFrequency);
+        lfeLowPassFrequency.setCurrentAndTargetValue ((SampleType) parameters.lfeLowPassFrequency);
+        samplesIntoTile = 0;
+
+        slope = parameters.slope;
+        setNumSectionsForSlope();
+        setCrossoverFrequency (crossoverFrequency.getCurrentValue());
+        setLfeLowPassFrequency (lfeLowPassFrequency.getCurrentValue());
+        updateStateVariableTargets (parameters);
+        updateLinearPhaseTargets (parameters);
+        stateVariableHighPass.reset();
+
+        topology = parameters.topology;
+        lfeGain = getLfeGain (parameters.lfeBoost);
+        linearPhaseCrossover.setPartitionSize (parameters.linearPhasePartitionSize);
+        linearPhaseCrossover.updateResponses();
+        multirateEnabled = parameters.multirate;
+        limiterEnabled = parameters.lfeLimiter;
+        limiter.setCeiling (juce::Decibels::decibelsToGain ((SampleType) parameters.lfeLimiterCeiling));
+        resetBassPaths();
+
+        setChannelDelays (parameters);
+        setChannelTrims (parameters);
+        speakerAlignment.reset();
+
+        setSubwoofers (parameters);
+        subwooferBank.reset();
+        subwooferAlignment.reset();
+    }
+
+    /** The delay the current mode adds to every output. */
+    int getLatencySamples() const noexcept     { return latencySamples; }
+
+    /** How many channel tiles (mains and bass path) were skipped as silent, or processed, since prepare(). */
+    juce::uint64 getNumSkippedTiles() const noexcept     { return mainsSilence.getNumSkipped() + bassSilence.getNumSkipped(); }
+    juce::uint64 getNumProcessedTiles() const noexcept   { return mainsSilence.getNumProcessed() + bassSilence.getNumProcessed(); }
+
+    /** How many worker threads share the channel groups with the audio thread. */
+    int getNumWorkers() const noexcept     { return workers.getNumWorkers(); }
+
+    /** Designs the linear-phase FIRs for any cutoff that moved, which process() then fades
+        to over one partition. Too slow for the audio thread in real time, so the message
+        thread polls this; an offline render can call it before each block instead.
+    */
+    void updateLinearPhaseResponses() noexcept     { linearPhaseCrossover.updateResponses(); }
+
+    /** The multi-rate bass path halves the rate for as long as it stays at or above
+        multirateMinimumRate, and its half-band chain keeps everything below multiratePassband.
+    */
+    static constexpr double multirateMinimumRate = 6000.0;
+    static constexpr double multiratePassband = 1000.0;
+
+    /** The rate the multi-rate bass path low-passes at, for a host running at sampleRate. */
+    static double getMultirateSampleRate (double sampleRate) noexcept
+    {
+        return sampleRate / (1 << getNumHalfBandStages (sampleRate, multirateMinimumRate));
+    }
+
+    //==============================================================================
+    /** Bass-manages the buffer in place with the given parameter values, which the
+        host block's first sample takes effect from. Blocks can be any length.
+
+        Only the fields marked in parameters.changed are looked at, so a block in
+        which nothing moved goes straight to the audio.
+    */
+    void process (juce::AudioBuffer<SampleType>& buffer, const Parameters& parameters) noexcept
+    {
+        if (parameters.changed != 0)
+            applyChanges (parameters);
+
+        // Run the whole chain one cache-sized tile at a time, so every pass after the
+        // first reads the tile from cache rather than streaming the block again. The
+        // first and last tiles of a block are short when the host's block boundaries
+        // don't fall on the stream's tile grid
+        for (int start = 0; start < buffer.getNumSamples();)
+        {
+            if (canProcessInParallel (buffer.getNumSamples() - start))
+            {
+                auto numSamples = juce::jmin (maximumParallelSamples, buffer.getNumSamples() - start);
+                processInParallel (buffer, start, numSamples);
+                start += numSamples;
+                continue;
+            }
+
+            auto numSamples = juce::jmin (tileSize - samplesIntoTile, buffer.getNumSamples() - start);
+
+            if (samplesIntoTile == 0)
+                advanceCutoffs();
+
+            processTile (buffer, start, numSamples);
+
+            if (subwooferBank.getNumSubwoofers() > 0)
+                processSubwoofers (buffer, start, numSamples);
+
+            if (speakerAlignment.isActive())
+            {
+                ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::speakerAlignment);
+                speakerAlignment.process (buffer.getArrayOfWritePointers(), start, numSamples);
+            }
+
+            if (limiterEnabled)
+                processLimiter (buffer, start, numSamples);
+
+            start += numSamples;
+            samplesIntoTile = (samplesIntoTile + numSamples) % tileSize;
+        }
+
+        if (meterSource.isActive())
+            pushMeterData (buffer);
+    }
+
+private:
+    //==============================================================================
+    void applyChanges (const Parameters& parameters) noexcept
+    {
+        using P = Parameters;
+
+        ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::coefficientUpdate);
+
+        if (parameters.hasChanged (P::multirateField))
+            setMultirateEnabled (parameters.multirate);
+
+        if (parameters.hasChanged (P::topologyField))
+            setTopology (parameters.topology);
+
+        if (parameters.hasChanged (P::slopeField))
+            setSlope (parameters.slope);
+
+        if (parameters.hasChanged (P::linearPhasePartitionSizeField))
+            setLinearPhasePartitionSize (parameters.linearPhasePartitionSize);
+
+        if (parameters.hasChanged (P::lfeBoostField))
+            lfeGain = getLfeGain (parameters.lfeBoost);
+
+        if (parameters.hasChanged (P::lfeLimiterField))
+            setLfeLimiter (parameters);
+
+        if (parameters.hasChanged (P::parallelChannelsField))
+            parallelEnabled = parameters.parallelChannels;
+
+        if (parameters.hasChanged (P::channelDelaysField))
+            setChannelDelays (parameters);
+
+        if (parameters.hasChanged (P::channelTrimsField))
+            setChannelTrims (parameters);
+
+        if (parameters.hasChanged (P::subwoofersField))
+            setSubwoofers (parameters);
+
+        // Only the active topology follows the cutoffs, so switching to another one
+        // has to bring its targets up to date too
+        if (parameters.hasChanged (P::crossoverFrequencyField | P::lfeLowPassFrequencyField | P::topologyField))
+        {
+            if (topology == CrossoverTopology::stateVariable)
+                updateStateVariableTargets (parameters);
+            else if (topology == CrossoverTopology::linearPhase)
+                updateLinearPhaseTargets (parameters);
+        }
+
+        if (parameters.hasChanged (P::crossoverFrequencyField))
+            crossoverFrequency.setTargetValue ((SampleType) parameters.crossoverFrequency);
+
+        if (parameters.hasChanged (P::lfeLowPassFrequencyField))
+            lfeLowPassFrequency.setTargetValue ((SampleType) parameters.lfeLowPassFrequency);
+    }
+
+    /** Steps the smoothed cutoffs a whole tile ahead and retunes whatever moved. */
+    void advanceCutoffs() noexcept
+    {
+        if (! crossoverFrequency.isSmoothing() && ! lfeLowPassFrequency.isSmoothing())
+            return;
+
+        ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::coefficientUpdate);
+
+        if (crossoverFrequency.isSmoothing())
+            setCrossoverFrequency (crossoverFrequency.skip (tileSize));
+
+        if (lfeLowPassFrequency.isSmoothing())
+            setLfeLowPassFrequency (lfeLowPassFrequency.skip (tileSize));
+    }
+
+    void setCrossoverFrequency (SampleType frequency) noexcept
+    {
+        // A table lookup for the high-passes, and the low-passes only recompute a few
+        // scalars, so this is allocation-free on the audio thread
+        typename Table::Section sections[Table::maximumNumSections];
+        coefficientTable->getHighPass (slope, frequency, sections);
+
+        for (int group = 0; group < numChannelGroups; ++group)
+            mainHighPass[(size_t) group].setSections (sections);
+
+        sumLowPass.setCutoffFrequency (frequency);
+        multirateSumLowPass.setCutoffFrequency (frequency);
+    }
+
+    void setNumSectionsForSlope() noexcept
+    {
+        for (int group = 0; group < numChannelGroups; ++group)
+            mainHighPass[(size_t) group].setNumSections (Table::getNumHighPassSections (slope));
+
+        auto lowPass = Table::getLowPassPrototype (slope);
+
+        for (auto* filter : { &sumLowPass, &multirateSumLowPass })
+            filter->setSections (lowPass.numSecondOrder, lowPass.dampings, lowPass.numFirstOrder);
+    }
+
+    void setLfeLowPassFrequency (SampleType frequency) noexcept
+    {
+        lfeLowPassFilter.setCutoffFrequency (frequency);
+        multirateLfeLowPassFilter.setCutoffFrequency (frequency);
+    }
+
+    void updateStateVariableTargets (const Parameters& parameters) noexcept
+    {
+        // Only the targets are set once per block, every filter ramps towards them
+        // sample by sample
+        auto crossover = (SampleType) parameters.crossoverFrequency;
+        auto lfe = (SampleType) parameters.lfeLowPassFrequency;
+
+        stateVariableHighPass.setCutoffFrequency (crossover);
+        stateVariableSumLowPass.setCutoffFrequency (crossover);
+        multirateStateVariableSumLowPass.setCutoffFrequency (crossover);
+
+        stateVariableLfeLowPass.setCutoffFrequency (lfe);
+        multirateStateVariableLfeLowPass.setCutoffFrequency (lfe);
+    }
+
+    void updateLinearPhaseTargets (const Parameters& parameters) noexcept
+    {
+        // Only asks for the cutoffs: the FIRs are designed off the audio thread
+        linearPhaseCrossover.setCrossoverFrequency (parameters.crossoverFrequency);
+        linearPhaseCrossover.setLfeLowPassFrequency (parameters.lfeLowPassFrequency);
+    }
+
+    void setMultirateEnabled (bool shouldBeEnabled) noexcept
+    {
+        if (shouldBeEnabled == multirateEnabled)
+            return;
+
+        multirateEnabled = shouldBeEnabled;
+        resetBassPaths();
+    }
+
+    void setTopology (CrossoverTopology newTopology) noexcept
+    {
+        if (newTopology == topology)
+            return;
+
+        topology = newTopology;
+
+        for (auto& highPass : mainHighPass)
+            highPass.reset();
+
+        stateVariableHighPass.reset();
+        resetBassPaths();
+    }
+
+    void setSlope (CrossoverSlope newSlope) noexcept
+    {
+        if (newSlope == slope)
+            return;
+
+        // The old state belongs to a different filter, so everything starts from silence
+        slope = newSlope;
+        setNumSectionsForSlope();
+        setCrossoverFrequency (crossoverFrequency.getCurrentValue());
+        resetBassPaths();
+    }
+
+    void setLinearPhasePartitionSize (int partitionSize) noexcept
+    {
+        if (partitionSize == linearPhaseCrossover.getPartitionSize())
+            return;
+
+        // Changes the latency, so the bass paths restart
+        linearPhaseCrossover.setPartitionSize (partitionSize);
+        resetBassPaths();
+    }
+
+    void setChannelDelays (const Parameters& parameters) noexcept
+    {
+        // A delay that changes jumps straight to its new length; it's a setup control,
+        // not one meant to be automated. Every channel the limiter doesn't delay waits
+        // for the ones it does
+        auto compensation = (double) getLimiterLatency();
+
+        for (int ch = 0; ch < speakerAlignment.getNumChannels(); ++ch)
+            speakerAlignment.setDelay (ch, parameters.channelDelays[(size_t) ch] * 0.001 * sampleRate
+                                             + (ch == channelMap.lfe ? 0.0 : compensation));
+    }
+
+    void setChannelTrims (const Parameters& parameters) noexcept
+    {
+        for (int ch = 0; ch < speakerAlignment.getNumChannels(); ++ch)
+            speakerAlignment.setGain (ch, juce::Decibels::decibelsToGain ((SampleType) parameters.channelTrims[(size_t) ch]));
+    }
+
+    void setSubwoofers (const Parameters& parameters) noexcept
+    {
+        for (int sub = 0; sub < subwooferBank.getNumSubwoofers(); ++sub)
+        {
+            auto gain = juce::Decibels::decibelsToGain ((SampleType) parameters.subwooferGains[(size_t) sub]);
+
+            subwooferBank.setLowPassFrequency (sub, (SampleType) parameters.subwooferLowPassFrequencies[(size_t) sub]);
+            subwooferBank.setGain (sub, parameters.subwooferInverts[(size_t) sub] ? -gain : gain);
+            subwooferAlignment.setDelay (sub, parameters.subwooferDelays[(size_t) sub] * 0.001 * sampleRate);
+        }
+    }
+
+    void setLfeLimiter (const Parameters& parameters) noexcept
+    {
+        limiter.setCeiling (juce::Decibels::decibelsToGain ((SampleType) parameters.lfeLimiterCeiling));
+
+        if (parameters.lfeLimiter == limiterEnabled)
+            return;
+
+        // Switching changes the latency: the limited channels start from an empty line
+        // and the others move their delays to match
+        limiterEnabled = parameters.lfeLimiter;
+        limiter.reset();
+        setChannelDelays (parameters);
+        latencySamples = crossoverLatency + getLimiterLatency();
+    }
+
+    int getLimiterLatency() const noexcept    { return limiterEnabled ? limiter.getLatencyInSamples() : 0; }
+
+    void resetBassPaths() noexcept
+    {
+        // Start the active path from silence so switching doesn't click on stale state
+        sumDecimator.reset();
+        lfeDecimator.reset();
+        bassInterpolator.reset();
+        multirateSumLowPass.reset();
+        multirateLfeLowPassFilter.reset();
+        sumLowPass.reset();
+        lfeLowPassFilter.reset();
+        stateVariableSumLowPass.reset();
+        stateVariableLfeLowPass.reset();
+        multirateStateVariableSumLowPass.reset();
+        multirateStateVariableLfeLowPass.reset();
+        linearPhaseCrossover.reset();
+        mainsDelay.reset();
+        mainsSilence.reset();
+        bassSilence.reset();
+
+        auto multirateLatency = multirateEnabled ? sumDecimator.getLatencyInSamples() + bassInterpolator.getLatencyInSamples() : 0;
+        mainsDelay.setDelay ((SampleType) multirateLatency);
+
+        crossoverLatency = topology == CrossoverTopology::linearPhase ? linearPhaseCrossover.getLatencyInSamples()
+                                                                      : multirateLatency;
+        latencySamples = crossoverLatency + getLimiterLatency();
+    }
+
+    //==============================================================================
+    void processTile (juce::AudioBuffer<SampleType>& buffer, int start, int numSamples) noexcept
+    {
+        SampleType* mainChannels[BassManagementChannelMap::maxMainChannels];
+        channelMap.getMainChannels (buffer, mainChannels, start);
+
+        auto lfe = buffer.getWritePointer (channelMap.lfe, start);
+        auto sum = sumBuffer.getWritePointer (0);
+
+        if (topology == CrossoverTopology::linearPhase)
+        {
+            // Splits the mains and produces the low-passed bass sum in one go
+            {
+                ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::mainHighPass);
+                linearPhaseCrossover.process (mainChannels, lfe, sum, numSamples);
+            }
+
+            ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::lfeMix);
+            mixBassIntoLfe (lfe, sum, numSamples);
+            return;
+        }
+
+        auto bassIdle = false;
+
+        // Sum the full range channels to a new buffer and low-pass
+        {
+            ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::bassSum);
+
+            sumMainChannels (mainChannels, sum, numSamples);
+            bassIdle = lowPassBassSum (lfe, sum, numSamples);
+        }
+
+        // Replace the full range output high-passed
+        {
+            ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::mainHighPass);
+
+            if (topology == CrossoverTopology::stateVariable)
+            {
+                int activeMains[BassManagementChannelMap::maxMainChannels] {};
+                auto numActiveMains = findActiveMains (stateVariableHighPass, mainChannels, 0, channelMap.numMains, numSamples, activeMains);
+
+                stateVariableHighPass.process (mainChannels, activeMains, numActiveMains, numSamples);
+                delayMains (mainChannels, 0, activeMains, numActiveMains, numSamples);
+            }
+            else
+            {
+                for (int group = 0; group < numChannelGroups; ++group)
+                    processChannelGroup (group, mainChannels, 0, numSamples);
+            }
+        }
+
+        mixBassSumIntoLfe (lfe, sum, numSamples, bassIdle);
+    }
+
+    /** Low-passes a tile of the bass sum, or in multi-rate mode the whole bass path, and
+        returns true if it was idle. Neither this nor mixBassSumIntoLfe() touches the
+        mains, so they can run while the mains are being filtered.
+    */
+    bool lowPassBassSum (SampleType* lfe, SampleType* sum, int numSamples) noexcept
+    {
+        auto bassSilent = SilenceDetector::isSilent (sum, numSamples) && SilenceDetector::isSilent (lfe, numSamples);
+
+        if (bassSilence.update (0, bassSilent, numSamples))
+        {
+            // Every filter on the path has rung out, nothing to do
+            return true;
+        }
+
+        if (multirateEnabled)
+            processMultirateBass (lfe, sum, numSamples);
+        else if (topology == CrossoverTopology::stateVariable)
+            stateVariableSumLowPass.process (sum, numSamples);
+        else
+            sumLowPass.process (sum, numSamples);
+
+        return false;
+    }
+
+    /** Low-passes the LFE channel and adds the bass sum to it, or clears it if the bass path
+        is idle. In multi-rate mode lowPassBassSum() has done it all already.
+    */
+    void mixBassSumIntoLfe (SampleType* lfe, const SampleType* sum, int numSamples, bool bassIdle) noexcept
+    {
+        if (bassIdle)
+        {
+            ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::lfeMix);
+            juce::FloatVectorOperations::clear (lfe, numSamples);
+        }
+        else if (! multirateEnabled)
+        {
+            // Replace the LFE channel with its low-passed version,
+            // then apply the LFE gain and add the summed low pass content in one pass
+            ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::lfeMix);
+
+            if (topology == CrossoverTopology::stateVariable)
+            {
+                stateVariableLfeLowPass.process (lfe, numSamples);
+            }
+            else
+            {
+                juce::dsp::AudioBlock<SampleType> lfeBlock (&lfe, 1, (size_t) numSamples);
+                lfeLowPassFilter.process (juce::dsp::ProcessContextReplacing<SampleType> (lfeBlock));
+            }
+
+            mixBassIntoLfe (lfe, sum, numSamples);
+        }
+    }
+
+    /** Lists which of numChannels consecutive mains, the first of which is main number
+        firstMain, have signal or are still ringing in highPass, and returns how many
+        there are. An idle channel's input passes through untouched since it is
+        already silent.
+    */
+    template <typename HighPass>
+    int findActiveMains (const HighPass& highPass, SampleType* const* channels, int firstMain, int numChannels,
+                         int numSamples, int* activeChannels) noexcept
+    {
+        auto numActive = 0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto silent = SilenceDetector::isSilent (channels[ch], numSamples)
+                            && highPass.isChannelStateBelow (ch, (SampleType) SilenceDetector::threshold);
+
+            if (! mainsSilence.update (firstMain + ch, silent, numSamples))
+                activeChannels[numActive++] = ch;
+        }
+
+        return numActive;
+    }
+
+    /** In multi-rate mode, keeps the active mains aligned with the interpolated bass. An
+        idle channel has been silent for longer than the delay, so its line holds only zeros.
+    */
+    void delayMains (SampleType* const* channels, int firstMain, const int* activeChannels, int numActive, int numSamples) noexcept
+    {
+        if (! multirateEnabled)
+            return;
+
+        for (int k = 0; k < numActive; ++k)
+        {
+            auto ch = activeChannels[k];
+            auto samples = channels[ch];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                mainsDelay.pushSample (firstMain + ch, samples[i]);
+                samples[i] = mainsDelay.popSample (firstMain + ch);
+            }
+        }
+    }
+
+    /** High-passes one channel group's mains over numSamples from offset on, which must
+        lie within one tile. Touches nothing another group uses, so groups can run on
+        different threads at once.
+    */
+    void processChannelGroup (int group, SampleType* const* mainChannels, int offset, int numSamples) noexcept
+    {
+        auto& highPass = mainHighPass[(size_t) group];
+        auto firstMain = group * channelGroupSize;
+
+        SampleType* channels[channelGroupSize];
+
+        for (int ch = 0; ch < highPass.getNumChannels(); ++ch)
+            channels[ch] = mainChannels[firstMain + ch] + offset;
+
+        int activeChannels[channelGroupSize];
+        auto numActive = findActiveMains (highPass, channels, firstMain, highPass.getNumChannels(), numSamples, activeChannels);
+
+        highPass.process (channels, activeChannels, numActive, numSamples);
+        delayMains (channels, firstMain, activeChannels, numActive, numSamples);
+    }
+
+    //==============================================================================
+    /** Calls function (offset, length, startsTile) for each run of numSamples that lies
+        within one tile, the first of them intoTile samples into its tile.
+    */
+    template <typename Function>
+    static void forEachTile (int intoTile, int numSamples, Function&& function) noexcept
+    {
+        for (int offset = 0; offset < numSamples;)
+        {
+            auto length = juce::jmin (tileSize - intoTile, numSamples - offset);
+            function (offset, length, intoTile == 0);
+
+            offset += length;
+            intoTile = 0;
+        }
+    }
+
+    /** The channel groups are only worth spreading over the workers for long enough
+        runs of a biquad crossover whose coefficients stay put: a per-sample ramp or a
+        coefficient step every tile would have to be shared between the groups.
+    */
+    bool canProcessInParallel (int numSamples) const noexcept
+    {
+        return parallelEnabled
+                && workers.getNumWorkers() > 0
+                && numSamples >= minimumParallelSamples
+                && topology == CrossoverTopology::biquad
+                && ! crossoverFrequency.isSmoothing();
+    }
+
+    /** Runs the whole chain over numSamples with the channel groups' high-passes spread
+        over the workers, one handoff for the lot.
+
+        The bass sum has to be taken before any main is filtered in place, so it's taken
+        for the whole run first. The workers then take their groups while this thread
+        runs the bass path, the subwoofers and its own groups, and everything that comes
+        after the crossover waits at the barrier for every group to finish. The output
+        is exactly what the tile-by-tile path gives.
+    */
+    void processInParallel (juce::AudioBuffer<SampleType>& buffer, int start, int numSamples) noexcept
+    {
+        channelMap.getMainChannels (buffer, parallelChannels, start);
+
+        auto lfe = buffer.getWritePointer (channelMap.lfe, start);
+        auto sum = sumBuffer.getWritePointer (0);
+
+        {
+            ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::bassSum);
+            sumMainChannels (parallelChannels, sum, numSamples);
+        }
+
+        parallelNumSamples = numSamples;
+        parallelIntoTile = samplesIntoTile;
+        workers.dispatch (processChannelGroupsOnWorker, this);
+
+        forEachTile (samplesIntoTile, numSamples, [&] (int offset, int length, bool startsTile)
+        {
+            if (startsTile)
+                advanceCutoffs();
+
+            bool bassIdle;
+
+            {
+                ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::bassSum);
+                bassIdle = lowPassBassSum (lfe + offset, sum + offset, length);
+            }
+
+            mixBassSumIntoLfe (lfe + offset, sum + offset, length, bassIdle);
+
+            if (subwooferBank.getNumSubwoofers() > 0)
+                processSubwoofers (buffer, start + offset, length);
+        });
+
+        {
+            ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::mainHighPass);
+            processChannelGroups (0);
+            workers.wait();
+        }
+
+        forEachTile (samplesIntoTile, numSamples, [&] (int offset, int length, bool)
+        {
+            if (speakerAlignment.isActive())
+            {
+                ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::speakerAlignment);
+                speakerAlignment.process (buffer.getArrayOfWritePointers(), start + offset, length);
+            }
+
+            if (limiterEnabled)
+                processLimiter (buffer, start + offset, length);
+        });
+
+        samplesIntoTile = (samplesIntoTile + numSamples) % tileSize;
+    }
+
+    /** One thread's share of processInParallel(): the audio thread is thread 0 and each
+        worker is one more than its index. Groups are dealt out to the threads in turn,
+        and each group goes tile by tile like the serial path.
+    */
+    void processChannelGroups (int thread) noexcept
+    {
+        for (int group = thread; group < numChannelGroups; group += workers.getNumWorkers() + 1)
+        {
+            forEachTile (parallelIntoTile, parallelNumSamples, [&] (int offset, int length, bool)
+            {
+                processChannelGroup (group, parallelChannels, offset, length);
+            });
+        }
+    }
+
+    static void processChannelGroupsOnWorker (void* engine, int worker) noexcept
+    {
+        static_cast<BassManagementEngine*> (engine)->processChannelGroups (worker + 1);
+    }
+
+    void processSubwoofers (juce::AudioBuffer<SampleType>& buffer, int start, int numSamples) noexcept
+    {
+        ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::lfeMix);
+
+        // Every sub is fed from the finished LFE channel, before its own alignment
+        auto* lfe = buffer.getReadPointer (channelMap.lfe, start);
+        auto* subwoofers = buffer.getArrayOfWritePointers() + firstSubwooferChannel;
+
+        if (SilenceDetector::isSilent (lfe, numSamples) && subwooferBank.isStateBelow ((SampleType) SilenceDetector::threshold))
+        {
+            for (int sub = 0; sub < subwooferBank.getNumSubwoofers(); ++sub)
+                juce::FloatVectorOperations::clear (subwoofers[sub] + start, numSamples);
+        }
+        else
+        {
+            subwooferBank.process (lfe, subwoofers, start, numSamples);
+        }
+
+        if (subwooferAlignment.isActive())
+            subwooferAlignment.process (subwoofers, start, numSamples);
+    }
+
+    void processLimiter (juce::AudioBuffer<SampleType>& buffer, int start, int numSamples) noexcept
+    {
+        ProcessingProfiler::ScopedStage stage (profiler, ProcessingProfiler::lfeMix);
+
+        // The finished LFE channel, then the subwoofer feeds
+        SampleType* limited[1 + BassManagementChannelMap::maxSubwoofers];
+        auto* channels = buffer.getArrayOfWritePointers();
+        limited[0] = channels[channelMap.lfe];
+
+        for (int sub = 0; sub < subwooferBank.getNumSubwoofers(); ++sub)
+            limited[1 + sub] = channels[firstSubwooferChannel + sub];
+
+        limiter.process (limited, start, numSamples);
+    }
+
+    static SampleType getLfeGain (bool boost) noexcept
+    {
+        // The LFE channel is recorded 10 dB down, the boost restores its reference level
+        return boost ? juce::Decibels::decibelsToGain (SampleType (10)) : SampleType (1);
+    }
+
+    void mixBassIntoLfe (SampleType* lfe, const SampleType* sum, int numSamples) noexcept
+    {
+        // The gained LFE plus the low-passed bass sum, in one pass
+        meterSource.addBassRedirect (sum, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            lfe[i] = lfe[i] * lfeGain + sum[i];
+    }
+
+    void processMultirateBass (SampleType* lfe, const SampleType* sum, int numSamples) noexcept
+    {
+        // Decimate the summed mains and the LFE, low-pass both and apply the LFE gain at
+        // the reduced rate, then interpolate the mix straight back into the LFE channel
+        auto lowSum = multirateBuffer.getWritePointer (0);
+        auto lowLfe = multirateBuffer.getWritePointer (1);
+
+        auto numLow = sumDecimator.process (sum, numSamples, lowSum);
+        lfeDecimator.process (lfe, numSamples, lowLfe);
+
+        if (topology == CrossoverTopology::stateVariable)
+        {
+            multirateStateVariableSumLowPass.process (lowSum, numLow);
+            multirateStateVariableLfeLowPass.process (lowLfe, numLow);
+        }
+        else
+        {
+            juce::dsp::AudioBlock<SampleType> lowLfeBlock (&lowLfe, 1, (size_t) numLow);
+            multirateSumLowPass.process (lowSum, numLow);
+            multirateLfeLowPassFilter.process (juce::dsp::ProcessContextReplacing<SampleType> (lowLfeBlock));
+        }
+
+        meterSource.addBassRedirect (lowSum, numLow);
+
+        // Same gain as the full-rate path so both modes sound identical
+        juce::FloatVectorOperations::addWithMultiply (lowSum, lowLfe, lfeGain, numLow);
+
+        bassInterpolator.process (lowSum, numLow, lfe, numSamples);
+    }
+
+    void pushMeterData (juce::AudioBuffer<SampleType>& buffer) noexcept
+    {
+        // Per-channel levels for the meters, then the LFE and the summed mains for the
+        // analyser. The mains are summed a tile at a time into the now idle sum buffer
+        meterSource.addLevels (buffer);
+
+        for (int start = 0; start < buffer.getNumSamples(); start += tileSize)
+        {
+            auto numSamples = juce::jmin (tileSize, buffer.getNumSamples() - start);
+
+            SampleType* mainChannels[BassManagementChannelMap::maxMainChannels];
+            channelMap.getMainChannels (buffer, mainChannels, start);
+
+            auto sum = sumBuffer.getWritePointer (0);
+            sumMainChannels (mainChannels, sum, numSamples);
+            meterSource.addSpectrumSamples (buffer.getReadPointer (channelMap.lfe, start), sum, numSamples);
+        }
+
+        meterSource.finishBlock();
+    }
+
+    //==============================================================================
+    ProcessingProfiler& profiler;
+
+    // Levels and analyser input for the editor, only gathered while it is open
+    MeterSource& meterSource;
+
+    BassManagementChannelMap channelMap;
+    typename BassManagementChannelMap::template SumFunction<SampleType> sumMainChannels = nullptr;
+
+    juce::AudioBuffer<SampleType> sumBuffer;
+    juce::SmoothedValue<SampleType, juce::ValueSmoothingTypes::Linear> crossoverFrequency, lfeLowPassFrequency;
+    SampleType lfeGain = 1;
+
+    // The crossover itself, with the slope's sections. The LFE channel's own
+    // low-pass is always a fourth order Linkwitz-Riley. The mains' biquad high-passes
+    // run in double whatever the SampleType, as the table's sections are designed,
+    // and are split into groups of four channels, each with its own state block,
+    // so that groups can run on different threads
+    using Table = CrossoverCoefficientTable<SampleType>;
+
+    static constexpr int channelGroupSize = 4;
+    static constexpr int maxChannelGroups = (BassManagementChannelMap::maxMainChannels + channelGroupSize - 1) / channelGroupSize;
+
+    std::array<typename Table::Cascade, maxChannelGroups> mainHighPass;
+    int numChannelGroups = 0;
+    TPTLowPassCascade<SampleType> sumLowPass;
+    std::shared_ptr<const Table> coefficientTable;
+    CrossoverSlope slope = CrossoverSlope::classic;
+    juce::dsp::LinkwitzRileyFilter<SampleType> lfeLowPassFilter;
+
+    // Multi-rate bass path: the sum and LFE are decimated, low-passed at the
+    // reduced rate and interpolated back, with the mains delayed to match
+    MultirateDecimator<SampleType> sumDecimator, lfeDecimator;
+    MultirateInterpolator<SampleType> bassInterpolator;
+    TPTLowPassCascade<SampleType> multirateSumLowPass;
+    juce::dsp::LinkwitzRileyFilter<SampleType> multirateLfeLowPassFilter;
+    juce::AudioBuffer<SampleType> multirateBuffer;
+    juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> mainsDelay;
+    bool multirateEnabled = false;
+
+    // Cutoff changes glide over this long. The biquad and Linkwitz-Riley filters step
+    // towards the target once per tile; the state-variable crossover has the same
+    // responses, but its cutoffs follow per-sample ramps
+    static constexpr double cutoffRampSeconds = 0.02;
+
+    TPTHighPassCascade<SampleType> stateVariableHighPass;
+    TPTLinkwitzRileyLowPass<SampleType> stateVariableSumLowPass, stateVariableLfeLowPass;
+    TPTLinkwitzRileyLowPass<SampleType> multirateStateVariableSumLowPass, multirateStateVariableLfeLowPass;
+
+    // Linear-phase crossover: FIR high and low bands through partitioned convolution.
+    // It always runs at the full rate, so the multi-rate switch doesn't apply to it
+    LinearPhaseCrossover<SampleType> linearPhaseCrossover;
+
+    CrossoverTopology topology = CrossoverTopology::biquad;
+    int latencySamples = 0, crossoverLatency = 0, samplesIntoTile = 0;
+
+    // Idle channels skip their filters: each main channel once its input and high-pass
+    // state are silent for longer than the mains delay plus a period of the lowest
+    // crossover, and the whole bass path once the sum and the LFE input are silent for
+    // longer than its tail. A ringing high-pass can have all its state near zero at
+    // once while it crosses zero, so one silent tile doesn't prove it has rung out.
+    // The linear-phase crossover's FIR tails live in the convolution, so it always runs
+    static constexpr double bassTailSeconds = 0.5;
+
+    SilenceDetector mainsSilence, bassSilence;
+
+    // Per-speaker distance delays and trims, run on each tile once it's bass-managed.
+    // With every channel at 0 ms and 0 dB it is skipped altogether
+    SpeakerAlignment<SampleType> speakerAlignment;
+    double sampleRate = 44100.0;
+
+    // The optional subwoofer bus: every feed's low-pass and gain in one SIMD bank,
+    // then their delays. The bus's channels follow the layout's in the buffer
+    SubwooferBank<SampleType> subwooferBank;
+    SpeakerAlignment<SampleType> subwooferAlignment;
+    int firstSubwooferChannel = 0;
+
+    // The optional true-peak limiter, the last thing the LFE and the subwoofer feeds
+    // go through. Its look-ahead delays them, and every other channel waits for it
+    LookAheadLimiter<SampleType> limiter;
+    bool limiterEnabled = false;
+
+    // Parallel channel groups: runs of at least minimumParallelSamples, split into
+    // handoffs of up to maximumParallelSamples, have their groups shared between the
+    // audio thread and the workers. Anything shorter costs more to hand off than it saves
+    static constexpr int minimumParallelSamples = 256;
+    static constexpr int maximumParallelSamples = 2048;
+
+    SampleType* parallelChannels[BassManagementChannelMap::maxMainChannels] = {};
+    int parallelNumSamples = 0, parallelIntoTile = 0;
+    bool parallelEnabled = false;
+
+    // Declared last, so its threads have stopped before anything they use is destroyed
+    RealtimeWorkerPool workers;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BassManagementEngine)
+};
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    Packing channels into SIMD lanes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+//==============================================================================
+/**
+    Moves a group of channels in and out of an interleaved buffer of
+    juce::dsp::SIMDRegister values, so that lane l of register i holds sample i
+    of channel firstChannel + l. Kernels that run the same filter over several
+    channels work on the interleaved buffer and so advance every lane at once.
+
+    Lanes beyond the last real channel are filled with zeros and never written
+    back. The channels may hold another sample type than the lanes, in which
+    case samples are converted on the way in and out.
+*/
+template <typename SampleType>
+struct ChannelLanes
+{
+   #if JUCE_USE_SIMD
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr int size = (int) Vector::SIMDNumElements;
+   #else
+    static constexpr int size = 1;
+   #endif
+
+    /** Number of registers needed to hold numChannels lanes. */
+    static constexpr int getNumVectors (int numChannels) noexcept    { return (numChannels + size - 1) / size; }
+
+    template <typename ChannelType>
+    static void gather (const ChannelType* const* channelData, int firstChannel, int numChannels,
+                        int start, int numSamples, SampleType* interleaved) noexcept
+    {
+        auto numLanes = juce::jmin (size, numChannels - firstChannel);
+
+        for (int l = 0; l < size; ++l)
+        {
+            if (l < numLanes)
+            {
+                auto* src = channelData[firstChannel + l] + start;
+
+                for (int i = 0; i < numSamples; ++i)
+                    interleaved[i * size + l] = static_cast<SampleType> (src[i]);
+            }
+            else
+            {
+                for (int i = 0; i < numSamples; ++i)
+                    interleaved[i * size + l] = 0;
+            }
+        }
+    }
+
+    template <typename ChannelType>
+    static void scatter (const SampleType* interleaved, ChannelType* const* channelData, int firstChannel,
+                         int numChannels, int start, int numSamples) noexcept
+    {
+        auto numLanes = juce::jmin (size, numChannels - firstChannel);
+
+        for (int l = 0; l < numLanes; ++l)
+        {
+            auto* dst = channelData[firstChannel + l] + start;
+
+            for (int i = 0; i < numSamples; ++i)
+                dst[i] = static_cast<ChannelType> (interleaved[i * size + l]);
+        }
+    }
+};
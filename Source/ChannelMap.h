@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    Which channels of a surround layout are bass-managed mains and which is
+    the LFE.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+#include <utility>
+
+//==============================================================================
+/**
+    The channel map for one of the supported surround layouts.
+
+    Every channel except the LFE is a main: its bass is summed to the LFE and the
+    channel itself is high-passed. Indices come from the negotiated
+    AudioChannelSet, so the map follows whatever channel order the layout uses.
+
+    The per-sample work that depends on the number of mains is done by kernels
+    instantiated for each supported count; getSumFunction() picks one once in
+    prepareToPlay, so the loop the audio thread runs has a compile-time trip
+    count over the channels and no per-channel branches.
+*/
+struct BassManagementChannelMap
+{
+    /** 9.1.6 has the most mains of the supported layouts. */
+    static constexpr int maxMainChannels = 15;
+
+    /** The mains plus the LFE. */
+    static constexpr int maxChannels = maxMainChannels + 1;
+
+    /** The optional subwoofer bus carries up to this many feeds. */
+    static constexpr int maxSubwoofers = 4;
+
+    static juce::Array<juce::AudioChannelSet> getSupportedLayouts()
+    {
+        return { juce::AudioChannelSet::create5point1(),
+                 juce::AudioChannelSet::create5point1point2(),
+                 juce::AudioChannelSet::create7point1(),
+                 juce::AudioChannelSet::create7point1point4(),
+                 juce::AudioChannelSet::create9point1point6() };
+    }
+
+    static bool isSupported (const juce::AudioChannelSet& set)
+    {
+        return getSupportedLayouts().contains (set);
+    }
+
+    /** The subwoofer bus is either switched off, mono for a single sub, or one discrete
+        channel per sub.
+    */
+    static bool isSupportedSubwooferLayout (const juce::AudioChannelSet& set)
+    {
+        return set.isDisabled()
+                || set == juce::AudioChannelSet::mono()
+                || (set.size() <= maxSubwoofers && set == juce::AudioChannelSet::discreteChannels (set.size()));
+    }
+
+    /** The supported layout a file with numChannels channels most likely uses, or a disabled set. */
+    static juce::AudioChannelSet getDefaultLayout (int numChannels)
+    {
+        for (auto& set : getSupportedLayouts())
+            if (set.size() == numChannels)
+                return set;
+
+        return juce::AudioChannelSet::disabled();
+    }
+
+    /** Builds the map for a supported layout. */
+    static BassManagementChannelMap fromChannelSet (const juce::AudioChannelSet& set)
+    {
+        jassert (isSupported (set));
+
+        BassManagementChannelMap map;
+        map.lfe = set.getChannelIndexForType (juce::AudioChannelSet::LFE);
+
+        for (int ch = 0; ch < set.size() && map.numMains < maxMainChannels; ++ch)
+            if (ch != map.lfe)
+                map.mains[(size_t) map.numMains++] = ch;
+
+        return map;
+    }
+
+    //==============================================================================
+    template <typename SampleType>
+    using SumFunction = void (*) (const SampleType* const* mainChannels, SampleType* sum, int numSamples);
+
+    /** The summing kernel specialised for this map's number of mains. */
+    template <typename SampleType>
+    SumFunction<SampleType> getSumFunction() const noexcept
+    {
+        switch (numMains)
+        {
+            case 5:     return sumChannels<SampleType, 5>;
+            case 7:     return sumChannels<SampleType, 7>;
+            case 11:    return sumChannels<SampleType, 11>;
+            case 15:    return sumChannels<SampleType, 15>;
+            default:    jassertfalse; return nullptr;
+        }
+    }
+
+    /** Gathers the write pointers of the mains from startSample onwards, in map order. */
+    template <typename SampleType>
+    void getMainChannels (juce::AudioBuffer<SampleType>& buffer, SampleType** mainChannels,
+                          int startSample = 0) const noexcept
+    {
+        for (int m = 0; m < numMains; ++m)
+            mainChannels[m] = buffer.getWritePointer (mains[(size_t) m], startSample);
+    }
+
+    //==============================================================================
+    std::array<int, maxMainChannels> mains {};
+    int numMains = 0;
+    int lfe = -1;
+
+private:
+    template <typename SampleType, int NumChannels>
+    static void sumChannels (const SampleType* const* channels, SampleType* sum, int numSamples) noexcept
+    {
+        sumChannels (channels, sum, numSamples, std::make_index_sequence<(size_t) NumChannels>());
+    }
+
+    template <typename SampleType, size_t... Channels>
+    static void sumChannels (const SampleType* const* channels, SampleType* sum, int numSamples,
+                             std::index_sequence<Channels...>) noexcept
+    {
+        const SampleType* source[] = { channels[Channels]... };
+
+        for (int i = 0; i < numSamples; ++i)
+            sum[i] = (source[Channels][i] + ...);
+    }
+};
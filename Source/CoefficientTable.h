@@ -0,0 +1,293 @@
+/*
+  ==============================================================================
+
+    Precomputed crossover coefficients for allocation-free parameter sweeps.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "MultichannelBiquad.h"
+
+/** The crossover alignments. classic is the original eight first order high-passes
+    against a fourth order Linkwitz-Riley low-pass; the others are matched pairs.
+*/
+enum class CrossoverSlope
+{
+    classic,
+    linkwitzRiley2, linkwitzRiley4, linkwitzRiley8,
+    butterworth2, butterworth3, butterworth4, butterworth5, butterworth6, butterworth7, butterworth8
+};
+
+static constexpr int numCrossoverSlopes = 11;
+
+//==============================================================================
+/**
+    Crossover filter sections designed ahead of time for one sample rate.
+
+    prepare() designs every section on a log-spaced grid over the crossover
+    parameter range; afterwards a new cutoff costs one table lookup and a linear
+    interpolation between the two neighbouring designs, with no filter design
+    and no heap traffic on the audio thread. Interpolating coefficients between
+    two stable designs stays stable because the stable region of (a1, a2) is
+    convex, and the grid is dense enough that the interpolated response is
+    indistinguishable from a fresh design.
+
+    The table holds the high-pass sections of every CrossoverSlope, so switching
+    slopes doesn't design anything either. The low-pass halves are run as TPT
+    cascades, which only need getLowPassPrototype() and the cutoff.
+
+    Sections are designed and held in double whatever the SampleType: the
+    steepest high-passes at the lowest cutoffs and highest rates put poles so
+    close to z = 1 that float coefficients move them off the design.
+
+    A table never changes once designed, so instances share one per sample rate
+    through getShared() rather than each designing their own.
+*/
+template <typename SampleType>
+class CrossoverCoefficientTable
+{
+public:
+    using Cascade = MultichannelBiquadCascade<SampleType, double>;
+    using Section = typename Cascade::Section;
+
+    static constexpr double minimumFrequency = 20.0;
+    static constexpr double maximumFrequency = 250.0;
+    static constexpr int numPoints = 128;
+
+    /** The most sections any slope uses, on either side. */
+    static constexpr int maximumNumSections = 8;
+
+    /** Designs the table. Does nothing if it was already built for this rate. */
+    void prepare (double newSampleRate)
+    {
+        if (newSampleRate == sampleRate)
+            return;
+
+        sampleRate = newSampleRate;
+
+        // Each slope's sections for every grid point, point by point
+        std::vector<Section> sections;
+
+        for (int slope = 0; slope < numCrossoverSlopes; ++slope)
+        {
+            auto& table = slopeHighPass[(size_t) slope];
+            table.clear();
+
+            for (int i = 0; i < numPoints; ++i)
+            {
+                design ((CrossoverSlope) slope, true, sampleRate, getGridFrequency (i), sections);
+                table.insert (table.end(), sections.begin(), sections.end());
+            }
+        }
+    }
+
+    /** The table for sampleRate that every instance in the process shares. The first
+        caller at a rate designs it and later ones only take a reference; it's freed
+        when the last holder lets go. Not for the audio thread, which reads through
+        the pointer this returns without any locking.
+    */
+    static std::shared_ptr<const CrossoverCoefficientTable> getShared (double sampleRate)
+    {
+        static std::mutex mutex;
+        static std::map<double, std::weak_ptr<const CrossoverCoefficientTable>> tables;
+
+        // Held while designing, so instances preparing at once on different threads
+        // wait for the first one's table rather than all designing their own
+        const std::lock_guard<std::mutex> lock (mutex);
+
+        if (auto existing = tables[sampleRate].lock())
+            return existing;
+
+        for (auto it = tables.begin(); it != tables.end();)
+            it = it->second.expired() ? tables.erase (it) : std::next (it);
+
+        auto table = std::make_shared<CrossoverCoefficientTable>();
+        table->prepare (sampleRate);
+        tables[sampleRate] = table;
+        return table;
+    }
+
+    double getSampleRate() const noexcept     { return sampleRate; }
+
+    /** Writes the high-pass sections of slope at frequency to sections, which needs room
+        for maximumNumSections, and returns how many there are.
+    */
+    int getHighPass (CrossoverSlope slope, SampleType frequency, Section* sections) const noexcept
+    {
+        auto& table = slopeHighPass[(size_t) slope];
+        auto numSections = (int) table.size() / numPoints;
+        jassert (numSections > 0 && numSections <= maximumNumSections);
+
+        lookup (table.data(), numSections, frequency, sections);
+        return numSections;
+    }
+
+    static int getNumHighPassSections (CrossoverSlope slope) noexcept   { return getNumSections (slope, true); }
+
+    /** A low-pass half as cutoff-independent sections: second order ones with their
+        damping 1 / Q, followed by first order ones.
+    */
+    struct LowPassPrototype
+    {
+        int numSecondOrder = 0, numFirstOrder = 0;
+        SampleType dampings[maximumNumSections / 2] = {};
+    };
+
+    static LowPassPrototype getLowPassPrototype (CrossoverSlope slope) noexcept
+    {
+        LowPassPrototype prototype;
+
+        // Same section order and Qs as FilterDesign's Butterworth designs
+        auto addButterworth = [&prototype] (int order)
+        {
+            for (int i = 0; i < order / 2; ++i)
+            {
+                auto angle = order % 2 == 1 ? (i + 1.0) * juce::MathConstants<double>::pi / order
+                                            : (2.0 * i + 1.0) * juce::MathConstants<double>::pi / (2.0 * order);
+                prototype.dampings[prototype.numSecondOrder++] = static_cast<SampleType> (2.0 * std::cos (angle));
+            }
+
+            prototype.numFirstOrder += order % 2;
+        };
+
+        switch (slope)
+        {
+            case CrossoverSlope::classic:
+            case CrossoverSlope::linkwitzRiley4:    addButterworth (2); addButterworth (2); break;
+            case CrossoverSlope::linkwitzRiley2:    addButterworth (1); addButterworth (1); break;
+            case CrossoverSlope::linkwitzRiley8:    addButterworth (4); addButterworth (4); break;
+
+            case CrossoverSlope::butterworth2:
+            case CrossoverSlope::butterworth3:
+            case CrossoverSlope::butterworth4:
+            case CrossoverSlope::butterworth5:
+            case CrossoverSlope::butterworth6:
+            case CrossoverSlope::butterworth7:
+            case CrossoverSlope::butterworth8:
+                addButterworth (2 + (int) slope - (int) CrossoverSlope::butterworth2);
+                break;
+        }
+
+        jassert (prototype.numSecondOrder + prototype.numFirstOrder == getNumSections (slope, false));
+        return prototype;
+    }
+
+    /** Designs the sections of one side of a crossover at frequency, replacing the contents of sections. */
+    static void design (CrossoverSlope slope, bool isHighPass, double sampleRate, SampleType frequency, std::vector<Section>& sections)
+    {
+        sections.clear();
+
+        auto addButterworth = [&] (int order)
+        {
+            auto designs = isHighPass ? juce::dsp::FilterDesign<double>::designIIRHighpassHighOrderButterworthMethod ((double) frequency, sampleRate, order)
+                                      : juce::dsp::FilterDesign<double>::designIIRLowpassHighOrderButterworthMethod ((double) frequency, sampleRate, order);
+
+            for (int i = 0; i < designs.size(); ++i)
+                sections.push_back (Cascade::toSection (*designs[i]));
+        };
+
+        switch (slope)
+        {
+            case CrossoverSlope::classic:
+                if (isHighPass)
+                {
+                    for (int i = 0; i < maximumNumSections; ++i)
+                        addButterworth (1);
+                }
+                else
+                {
+                    addButterworth (2);
+                    addButterworth (2);
+                }
+
+                break;
+
+            // A Linkwitz-Riley filter is its half-order Butterworth squared
+            case CrossoverSlope::linkwitzRiley2:    addButterworth (1); addButterworth (1); break;
+            case CrossoverSlope::linkwitzRiley4:    addButterworth (2); addButterworth (2); break;
+            case CrossoverSlope::linkwitzRiley8:    addButterworth (4); addButterworth (4); break;
+
+            case CrossoverSlope::butterworth2:
+            case CrossoverSlope::butterworth3:
+            case CrossoverSlope::butterworth4:
+            case CrossoverSlope::butterworth5:
+            case CrossoverSlope::butterworth6:
+            case CrossoverSlope::butterworth7:
+            case CrossoverSlope::butterworth8:
+                addButterworth (2 + (int) slope - (int) CrossoverSlope::butterworth2);
+                break;
+        }
+
+        // The two halves of a second order Linkwitz-Riley crossover are 180 degrees
+        // apart, so the high-pass is inverted for them to sum flat
+        if (slope == CrossoverSlope::linkwitzRiley2 && isHighPass)
+        {
+            auto& s = sections.front();
+            s.b0 = -s.b0;
+            s.b1 = -s.b1;
+            s.b2 = -s.b2;
+        }
+
+        jassert ((int) sections.size() == getNumSections (slope, isHighPass));
+    }
+
+private:
+    static int getNumSections (CrossoverSlope slope, bool isHighPass) noexcept
+    {
+        switch (slope)
+        {
+            case CrossoverSlope::classic:           return isHighPass ? maximumNumSections : 2;
+            case CrossoverSlope::linkwitzRiley2:    return 2;
+            case CrossoverSlope::linkwitzRiley4:    return 2;
+            case CrossoverSlope::linkwitzRiley8:    return 4;
+            case CrossoverSlope::butterworth2:
+            case CrossoverSlope::butterworth3:
+            case CrossoverSlope::butterworth4:
+            case CrossoverSlope::butterworth5:
+            case CrossoverSlope::butterworth6:
+            case CrossoverSlope::butterworth7:
+            case CrossoverSlope::butterworth8:      return (3 + (int) slope - (int) CrossoverSlope::butterworth2) / 2;
+        }
+
+        return 0;
+    }
+
+    static SampleType getGridFrequency (int point) noexcept
+    {
+        return static_cast<SampleType> (minimumFrequency * std::pow (maximumFrequency / minimumFrequency, point / (double) (numPoints - 1)));
+    }
+
+    /** Interpolates numSections consecutive sections between the two grid points around frequency. */
+    static void lookup (const Section* table, int numSections, SampleType frequency, Section* sections) noexcept
+    {
+        auto position = std::log (juce::jlimit ((double) minimumFrequency, (double) maximumFrequency, (double) frequency) / minimumFrequency)
+                          / std::log (maximumFrequency / minimumFrequency) * (numPoints - 1);
+        auto index = juce::jmin ((int) position, numPoints - 2);
+        auto alpha = position - index;
+
+        for (int s = 0; s < numSections; ++s)
+        {
+            auto& a = table[index * numSections + s];
+            auto& b = table[(index + 1) * numSections + s];
+
+            sections[s] = { a.b0 + alpha * (b.b0 - a.b0),
+                            a.b1 + alpha * (b.b1 - a.b1),
+                            a.b2 + alpha * (b.b2 - a.b2),
+                            a.a1 + alpha * (b.a1 - a.a1),
+                            a.a2 + alpha * (b.a2 - a.a2) };
+        }
+    }
+
+    double sampleRate = 0.0;
+    std::array<std::vector<Section>, numCrossoverSlopes> slopeHighPass;
+
+    JUCE_LEAK_DETECTOR (CrossoverCoefficientTable)
+};
@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    Linear-phase crossover built on partitioned FFT convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "PartitionedConvolution.h"
+
+#include <atomic>
+#include <type_traits>
+
+//==============================================================================
+/**
+    A linear-phase bass-management crossover.
+
+    The low-pass is a Blackman-windowed sinc, and each main's high-pass is its
+    delayed input minus its low-passed copy. Low and high bands therefore sum
+    back to a pure delay, and neither band has phase distortion. Because the
+    low-pass is linear, the sum of the mains' low bands is exactly the low-passed
+    bass sum, so the sum needs no convolution of its own. The LFE gets a second
+    FIR at its own cutoff.
+
+    The filters run through PartitionedConvolution, so the total latency is the
+    FIR's group delay plus one partition. The audio thread only asks for a new
+    cutoff: redesigning an FIR of thousands of taps and transforming all its
+    partitions is done by updateResponses() on another thread, and the
+    convolution then fades to the new response over one partition.
+
+    juce::dsp::FFT only works in float, so the convolutions always do. With
+    SampleType = double the low bands are rounded to float on the way in, but
+    the dry delay and the subtraction that forms the high bands stay in double.
+*/
+template <typename SampleType>
+class LinearPhaseCrossover
+{
+public:
+    /** FIR length. The Blackman transition band is about 5.5 / lengthSeconds Hz wide, whatever the rate. */
+    static constexpr double lengthSeconds = 0.08;
+
+    void prepare (double newSampleRate, int newNumMainChannels, int maximumBlockSize)
+    {
+        sampleRate = newSampleRate;
+        numMainChannels = newNumMainChannels;
+        numTaps = juce::roundToInt (sampleRate * lengthSeconds) | 1;
+
+        window.resize ((size_t) numTaps);
+        taps.resize ((size_t) numTaps);
+
+        auto pi = juce::MathConstants<double>::pi;
+
+        for (int n = 0; n < numTaps; ++n)
+            window[(size_t) n] = 0.42 - 0.5 * std::cos (2.0 * pi * n / (numTaps - 1))
+                                      + 0.08 * std::cos (4.0 * pi * n / (numTaps - 1));
+
+        mainsConvolution.prepare (numMainChannels, numTaps);
+        lfeConvolution.prepare (1, numTaps);
+        lowBands.setSize (numMainChannels, maximumBlockSize);
+        lfeBand.setSize (1, std::is_same_v<SampleType, float> ? 0 : maximumBlockSize);
+
+        dryDelay.setSize (numMainChannels, juce::nextPowerOfTwo (PartitionedConvolution::maximumPartitionSize + numTaps));
+
+        crossoverFrequency = lfeLowPassFrequency = 0.0f;
+        targetCrossoverFrequency = targetLfeLowPassFrequency = 0.0f;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        mainsConvolution.reset();
+        lfeConvolution.reset();
+        dryDelay.clear();
+        dryPosition = 0;
+    }
+
+    /** Samples of delay on every output: the FIR group delay plus one partition. */
+    int getLatencyInSamples() const noexcept    { return (numTaps - 1) / 2 + mainsConvolution.getLatencyInSamples(); }
+
+    /** Trades latency against CPU; this clears the filter state. */
+    void setPartitionSize (int partitionSize) noexcept
+    {
+        mainsConvolution.setPartitionSize (partitionSize);
+        lfeConvolution.setPartitionSize (partitionSize);
+        reset();
+    }
+
+    int getPartitionSize() const noexcept     { return mainsConvolution.getPartitionSize(); }
+
+    /** Audio thread: asks for a new crossover cutoff, which the next updateResponses() designs. */
+    void setCrossoverFrequency (float frequency) noexcept
+    {
+        targetCrossoverFrequency.store (frequency, std::memory_order_relaxed);
+    }
+
+    /** Audio thread: asks for a new LFE cutoff, which the next updateResponses() designs. */
+    void setLfeLowPassFrequency (float frequency) noexcept
+    {
+        targetLfeLowPassFrequency.store (frequency, std::memory_order_relaxed);
+    }
+
+    /** Designs the FIR for any cutoff that was asked for since the last call. Not for
+        the audio thread while it plays in real time: the message thread polls this.
+
+        The first call after prepare() puts the responses in place at once. Later ones
+        hand them to the convolutions to fade to; a convolution that hasn't taken over
+        the last one yet gets its new cutoff on a later call. Calls from several threads
+        are safe, as all but one return without doing anything.
+    */
+    void updateResponses() noexcept
+    {
+        if (designing.test_and_set (std::memory_order_acquire))
+            return;
+
+        updateResponse (mainsConvolution, targetCrossoverFrequency, crossoverFrequency);
+        updateResponse (lfeConvolution, targetLfeLowPassFrequency, lfeLowPassFrequency);
+
+        designing.clear (std::memory_order_release);
+    }
+
+    /** Splits the mains in place, leaving their high bands, and writes the sum of their
+        low bands to bassSum. The LFE is low-passed in place.
+    */
+    void process (SampleType* const* mainChannels, SampleType* lfe, SampleType* bassSum, int numSamples) noexcept
+    {
+        jassert (numSamples <= lowBands.getNumSamples());
+
+        for (int ch = 0; ch < numMainChannels; ++ch)
+            std::copy (mainChannels[ch], mainChannels[ch] + numSamples, lowBands.getWritePointer (ch));
+
+        mainsConvolution.process (lowBands.getArrayOfWritePointers(), numSamples);
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            lfeConvolution.process (&lfe, numSamples);
+        }
+        else
+        {
+            auto* band = lfeBand.getWritePointer (0);
+            std::copy (lfe, lfe + numSamples, band);
+            lfeConvolution.process (&band, numSamples);
+            std::copy (band, band + numSamples, lfe);
+        }
+
+        auto delay = getLatencyInSamples();
+        auto mask = dryDelay.getNumSamples() - 1;
+
+        juce::FloatVectorOperations::clear (bassSum, numSamples);
+
+        for (int ch = 0; ch < numMainChannels; ++ch)
+        {
+            auto* samples = mainChannels[ch];
+            auto* low = lowBands.getReadPointer (ch);
+            auto* ring = dryDelay.getWritePointer (ch);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto position = (dryPosition + i) & mask;
+                ring[position] = samples[i];
+                samples[i] = ring[(position - delay) & mask] - low[i];
+                bassSum[i] += low[i];
+            }
+        }
+
+        dryPosition = (dryPosition + numSamples) & mask;
+    }
+
+private:
+    void updateResponse (PartitionedConvolution& convolution, const std::atomic<float>& target, float& designed) noexcept
+    {
+        auto frequency = target.load (std::memory_order_relaxed);
+
+        if (frequency == designed || convolution.hasNextImpulseResponse())
+            return;
+
+        designLowPass (frequency);
+
+        if (designed == 0.0f)
+            convolution.setImpulseResponse (taps.data(), numTaps);
+        else
+            convolution.setNextImpulseResponse (taps.data(), numTaps);
+
+        designed = frequency;
+    }
+
+    void designLowPass (float frequency) noexcept
+    {
+        auto centre = (numTaps - 1) / 2;
+        auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        double sum = 0.0;
+
+        for (int n = 0; n < numTaps; ++n)
+        {
+            auto offset = n - centre;
+            auto sinc = offset == 0 ? omega / juce::MathConstants<double>::pi
+                                    : std::sin (omega * offset) / (juce::MathConstants<double>::pi * offset);
+
+            taps[(size_t) n] = static_cast<float> (sinc * window[(size_t) n]);
+            sum += taps[(size_t) n];
+        }
+
+        // Unity gain at DC, so the bands are exactly complementary there
+        for (auto& t : taps)
+            t = static_cast<float> (t / sum);
+    }
+
+    PartitionedConvolution mainsConvolution, lfeConvolution;
+    std::vector<double> window;
+    std::vector<float> taps;
+    juce::AudioBuffer<float> lowBands, lfeBand;
+    juce::AudioBuffer<SampleType> dryDelay;
+
+    double sampleRate = 44100.0;
+
+    // The cutoffs the audio thread asked for, and those of the latest designs
+    std::atomic<float> targetCrossoverFrequency { 0.0f }, targetLfeLowPassFrequency { 0.0f };
+    float crossoverFrequency = 0.0f, lfeLowPassFrequency = 0.0f;
+    std::atomic_flag designing = ATOMIC_FLAG_INIT;
+    int numMainChannels = 0, numTaps = 1, dryPosition = 0;
+
+    JUCE_LEAK_DETECTOR (LinearPhaseCrossover)
+};
@@ -0,0 +1,237 @@
+/*
+  ==============================================================================
+
+    A look-ahead true-peak limiter for the LFE and subwoofer feeds.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+//==============================================================================
+/**
+    Keeps the LFE and subwoofer outputs under a true-peak ceiling without
+    clipping them.
+
+    Each channel's peak is estimated between its samples as well as at them,
+    by interpolating three points between every pair of samples (a 4x
+    oversampled view) with short windowed-sinc kernels. The gain needed to
+    hold that peak under the ceiling is then looked ahead lookAheadSeconds:
+    the largest peak over the window comes from a monotonic deque, so the
+    detector costs O(1) per sample whatever the window length. The gain is
+    held for the window and smoothed by a moving average of the same length,
+    which reaches the held value exactly when the peak comes out of the delay
+    line, so the output never exceeds the ceiling and the gain never steps.
+    Releases are exponential.
+
+    The audio is delayed by getLatencyInSamples(), and the caller has to delay
+    every other channel by as much. Nothing allocates after prepare().
+*/
+template <typename SampleType>
+class LookAheadLimiter
+{
+public:
+    static constexpr double lookAheadSeconds = 0.002;
+    static constexpr double releaseSeconds = 0.2;
+
+    LookAheadLimiter() = default;
+
+    /** Allocates every channel's lines. Call this from prepareToPlay, never from the audio thread. */
+    void prepare (double sampleRate, int newNumChannels)
+    {
+        jassert (newNumChannels >= 0);
+
+        numChannels = newNumChannels;
+        windowLength = juce::jmax (1, juce::roundToInt (sampleRate * lookAheadSeconds)) + 1;
+        latency = interpolatorDelay + windowLength - 1;
+        lineMask = juce::nextPowerOfTwo (latency + 1) - 1;
+        dequeMask = juce::nextPowerOfTwo (windowLength + 1) - 1;
+        releaseCoefficient = static_cast<SampleType> (1.0 - std::exp (-1.0 / (releaseSeconds * sampleRate)));
+
+        designInterpolator();
+
+        channels.resize ((size_t) numChannels);
+
+        for (auto& c : channels)
+        {
+            c.line.assign ((size_t) lineMask + 1, SampleType (0));
+            c.dequePeaks.assign ((size_t) dequeMask + 1, SampleType (0));
+            c.dequeIndices.assign ((size_t) dequeMask + 1, 0);
+            c.gains.assign ((size_t) windowLength, SampleType (1));
+        }
+
+        reset();
+    }
+
+    /** Clears the lines and releases the gain fully. */
+    void reset() noexcept
+    {
+        for (auto& c : channels)
+        {
+            std::fill (std::begin (c.history), std::end (c.history), SampleType (0));
+            std::fill (c.line.begin(), c.line.end(), SampleType (0));
+            std::fill (c.gains.begin(), c.gains.end(), SampleType (1));
+            c.dequeFront = c.dequeBack = 0;
+            c.gainSum = (double) windowLength;
+            c.envelope = SampleType (1);
+            c.gainPosition = 0;
+        }
+
+        historyPosition = 0;
+        writePosition = 0;
+        sampleIndex = 0;
+    }
+
+    int getNumChannels() const noexcept         { return numChannels; }
+
+    /** How far the limited channels are delayed. */
+    int getLatencyInSamples() const noexcept    { return latency; }
+
+    /** Sets the highest true peak let through, as a linear gain. */
+    void setCeiling (SampleType newCeiling) noexcept
+    {
+        jassert (newCeiling > 0);
+        ceiling = newCeiling;
+    }
+
+    //==============================================================================
+    /** Limits numSamples of every channel from startSample on, in place. channelData
+        must hold getNumChannels() pointers.
+    */
+    void process (SampleType* const* channelData, int startSample, int numSamples) noexcept
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& c = channels[(size_t) ch];
+            auto* data = channelData[ch] + startSample;
+            auto index = sampleIndex;
+            auto position = writePosition;
+            auto historyWrite = historyPosition;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto x = data[i];
+                auto peak = estimatePeak (c, x, historyWrite);
+                historyWrite = (historyWrite + 1) % numTaps;
+
+                // The deque holds the peaks of the window in decreasing order: anything
+                // smaller than the newcomer can never be the window's maximum again
+                while (c.dequeBack != c.dequeFront && c.dequePeaks[(c.dequeBack - 1) & dequeMask] <= peak)
+                    --c.dequeBack;
+
+                c.dequePeaks[c.dequeBack & dequeMask] = peak;
+                c.dequeIndices[c.dequeBack & dequeMask] = index;
+                ++c.dequeBack;
+
+                if (index - c.dequeIndices[c.dequeFront & dequeMask] >= (juce::uint32) windowLength)
+                    ++c.dequeFront;
+
+                auto windowPeak = c.dequePeaks[c.dequeFront & dequeMask];
+                auto target = windowPeak > ceiling ? ceiling / windowPeak : SampleType (1);
+
+                // Attacks are instant here and smoothed by the average; releases glide
+                c.envelope = target < c.envelope ? target : c.envelope + (target - c.envelope) * releaseCoefficient;
+
+                c.gainSum += (double) c.envelope - (double) c.gains[(size_t) c.gainPosition];
+                c.gains[(size_t) c.gainPosition] = c.envelope;
+                c.gainPosition = c.gainPosition + 1 < windowLength ? c.gainPosition + 1 : 0;
+
+                c.line[(size_t) position] = x;
+                data[i] = c.line[(size_t) ((position - latency) & lineMask)] * static_cast<SampleType> (c.gainSum / windowLength);
+
+                position = (position + 1) & lineMask;
+                ++index;
+            }
+        }
+
+        historyPosition = (historyPosition + numSamples) % numTaps;
+        writePosition = (writePosition + numSamples) & lineMask;
+        sampleIndex += (juce::uint32) numSamples;
+    }
+
+private:
+    //==============================================================================
+    // Taps per interpolated point. The estimate for a sample is ready this many
+    // samples later, half the kernel length
+    static constexpr int numTaps = 8;
+    static constexpr int interpolatorDelay = numTaps / 2;
+    static constexpr int numPhases = 3;
+
+    struct Channel
+    {
+        // The last numTaps inputs, written twice so they can always be read in one run
+        SampleType history[2 * numTaps] = {};
+
+        std::vector<SampleType> line, dequePeaks, gains;
+        std::vector<juce::uint32> dequeIndices;
+        juce::uint32 dequeFront = 0, dequeBack = 0;
+        double gainSum = 0.0;
+        SampleType envelope = 1;
+        int gainPosition = 0;
+    };
+
+    /** Hann-windowed sinc kernels for the points a quarter, half and three quarters of the
+        way from each sample to the next, normalised to unity gain at DC.
+    */
+    void designInterpolator() noexcept
+    {
+        for (int phase = 0; phase < numPhases; ++phase)
+        {
+            auto fraction = (phase + 1) / (double) (numPhases + 1);
+            double taps[numTaps], sum = 0.0;
+
+            for (int j = 0; j < numTaps; ++j)
+            {
+                // Distance from the interpolated point to the tap's sample, which runs
+                // from the oldest in the history to the newest
+                auto distance = j - (numTaps - 1 - interpolatorDelay) - fraction;
+                auto x = juce::MathConstants<double>::pi * distance;
+                auto sinc = distance == 0.0 ? 1.0 : std::sin (x) / x;
+                auto window = 0.5 + 0.5 * std::cos (juce::MathConstants<double>::pi * distance / (interpolatorDelay + 1));
+
+                taps[j] = sinc * window;
+                sum += taps[j];
+            }
+
+            for (int j = 0; j < numTaps; ++j)
+                kernels[phase][j] = static_cast<SampleType> (taps[j] / sum);
+        }
+    }
+
+    /** Adds x to the channel's history and returns the largest magnitude at or just after
+        the sample interpolatorDelay back.
+    */
+    SampleType estimatePeak (Channel& c, SampleType x, int historyWrite) const noexcept
+    {
+        c.history[historyWrite] = x;
+        c.history[historyWrite + numTaps] = x;
+
+        // Oldest first
+        auto* recent = c.history + historyWrite + 1;
+        auto peak = std::abs (recent[numTaps - 1 - interpolatorDelay]);
+
+        for (int phase = 0; phase < numPhases; ++phase)
+        {
+            SampleType point = 0;
+
+            for (int j = 0; j < numTaps; ++j)
+                point += kernels[phase][j] * recent[j];
+
+            peak = juce::jmax (peak, std::abs (point));
+        }
+
+        return peak;
+    }
+
+    //==============================================================================
+    std::vector<Channel> channels;
+    SampleType kernels[numPhases][numTaps] = {};
+    SampleType ceiling = 1, releaseCoefficient = 0;
+    int numChannels = 0, windowLength = 1, latency = 0;
+    int lineMask = 0, dequeMask = 0, writePosition = 0, historyPosition = 0;
+    juce::uint32 sampleIndex = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LookAheadLimiter)
+};
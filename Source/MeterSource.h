@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    Level and spectrum data handed from the audio thread to the editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+
+//==============================================================================
+/**
+    Carries metering data from processBlock to the editor through wait-free
+    single-producer single-consumer FIFOs (juce::AbstractFifo).
+
+    The audio thread does no more than sum squares, track peaks and copy two
+    streams of samples. Everything else, including FFTs and drawing, happens on
+    the reading side. Nothing is gathered at all unless an editor has called
+    setActive (true), so closed instances pay for a single atomic load per block.
+
+    The analyser's sample FIFOs are only allocated the first time an editor
+    activates the source, since most instances never show one, and are kept
+    from then on. prepare() only records the layout and rate, so the reader
+    never sees a buffer being resized under it.
+*/
+class MeterSource
+{
+public:
+    static constexpr int maxChannels = 16;
+    static constexpr int summaryFifoSize = 128;
+    static constexpr int spectrumFifoSize = 1 << 15;
+
+    /** Per-block levels. Peaks are absolute sample values, RMS comes from sum of squares / samples. */
+    struct Summary
+    {
+        std::array<float, maxChannels> peak {}, sumOfSquares {};
+        float bassSumOfSquares = 0.0f;
+        int numSamples = 0, numBassSamples = 0;
+
+        /** Folds another summary into this one. */
+        void add (const Summary& other) noexcept
+        {
+            for (size_t ch = 0; ch < (size_t) maxChannels; ++ch)
+            {
+                peak[ch] = juce::jmax (peak[ch], other.peak[ch]);
+                sumOfSquares[ch] += other.sumOfSquares[ch];
+            }
+
+            bassSumOfSquares += other.bassSumOfSquares;
+            numSamples += other.numSamples;
+            numBassSamples += other.numBassSamples;
+        }
+
+        float getRMS (int channel) const noexcept
+        {
+            return numSamples > 0 ? std::sqrt (sumOfSquares[(size_t) channel] / (float) numSamples) : 0.0f;
+        }
+
+        float getBassRMS() const noexcept
+        {
+            return numBassSamples > 0 ? std::sqrt (bassSumOfSquares / (float) numBassSamples) : 0.0f;
+        }
+    };
+
+    MeterSource() = default;
+
+    void prepare (int newNumChannels, double newSampleRate) noexcept
+    {
+        numChannels = juce::jmin (newNumChannels, maxChannels);
+        sampleRate = newSampleRate;
+    }
+
+    int getNumChannels() const noexcept         { return numChannels; }
+    double getSampleRate() const noexcept       { return sampleRate; }
+
+    /** Called by the editor when it opens and closes. The first activation allocates the
+        analyser's FIFOs, so this must not be called from the audio thread.
+    */
+    void setActive (bool shouldBeActive)
+    {
+        if (shouldBeActive && lfeSamples.empty())
+        {
+            lfeSamples.resize ((size_t) spectrumFifoSize);
+            mainsSamples.resize ((size_t) spectrumFifoSize);
+        }
+
+        active.store (shouldBeActive, std::memory_order_release);
+    }
+
+    bool isActive() const noexcept                    { return active.load (std::memory_order_acquire); }
+
+    //==============================================================================
+    /** Audio thread: adds every channel's peak and energy to the current block. */
+    template <typename SampleType>
+    void addLevels (const juce::AudioBuffer<SampleType>& buffer) noexcept
+    {
+        auto num = juce::jmin (buffer.getNumChannels(), (int) numChannels);
+
+        for (int ch = 0; ch < num; ++ch)
+        {
+            auto* samples = buffer.getReadPointer (ch);
+            auto range = juce::FloatVectorOperations::findMinAndMax (samples, buffer.getNumSamples());
+            SampleType sumOfSquares = 0;
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                sumOfSquares += samples[i] * samples[i];
+
+            current.peak[(size_t) ch] = juce::jmax (current.peak[(size_t) ch], (float) -range.getStart(), (float) range.getEnd());
+            current.sumOfSquares[(size_t) ch] += (float) sumOfSquares;
+        }
+
+        current.numSamples += buffer.getNumSamples();
+    }
+
+    /** Audio thread: adds the low-passed bass that was redirected to the LFE, at any rate. */
+    template <typename SampleType>
+    void addBassRedirect (const SampleType* samples, int numSamples) noexcept
+    {
+        if (! isActive())
+            return;
+
+        for (int i = 0; i < numSamples; ++i)
+            current.bassSumOfSquares += (float) (samples[i] * samples[i]);
+
+        current.numBassSamples += numSamples;
+    }
+
+    /** Audio thread: queues LFE and summed mains output for the analyser, rounded to float.
+        Drops samples if the reader falls behind.
+    */
+    template <typename SampleType>
+    void addSpectrumSamples (const SampleType* lfe, const SampleType* mains, int numSamples) noexcept
+    {
+        int start1, size1, start2, size2;
+        spectrumFifo.prepareToWrite (numSamples, start1, size1, start2, size2);
+
+        std::copy (lfe, lfe + size1, lfeSamples.begin() + start1);
+        std::copy (mains, mains + size1, mainsSamples.begin() + start1);
+        std::copy (lfe + size1, lfe + size1 + size2, lfeSamples.begin() + start2);
+        std::copy (mains + size1, mains + size1 + size2, mainsSamples.begin() + start2);
+
+        spectrumFifo.finishedWrite (size1 + size2);
+    }
+
+    /** Audio thread: publishes the current block's summary and starts a new one. */
+    void finishBlock() noexcept
+    {
+        int start1, size1, start2, size2;
+        summaryFifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            summaries[(size_t) start1] = current;
+
+        summaryFifo.finishedWrite (size1);
+        current = {};
+    }
+
+    //==============================================================================
+    /** Reader: folds every queued summary into result. Returns how many there were. */
+    int readSummaries (Summary& result) noexcept
+    {
+        int start1, size1, start2, size2;
+        summaryFifo.prepareToRead (summaryFifo.getNumReady(), start1, size1, start2, size2);
+
+        for (int i = 0; i < size1; ++i)
+            result.add (summaries[(size_t) (start1 + i)]);
+
+        for (int i = 0; i < size2; ++i)
+            result.add (summaries[(size_t) (start2 + i)]);
+
+        summaryFifo.finishedRead (size1 + size2);
+        return size1 + size2;
+    }
+
+    /** Reader: pops up to maxSamples of analyser input. Returns how many were read. */
+    int readSpectrumSamples (float* lfe, float* mains, int maxSamples) noexcept
+    {
+        int start1, size1, start2, size2;
+        spectrumFifo.prepareToRead (juce::jmin (maxSamples, spectrumFifo.getNumReady()), start1, size1, start2, size2);
+
+        std::copy (lfeSamples.begin() + start1, lfeSamples.begin() + start1 + size1, lfe);
+        std::copy (mainsSamples.begin() + start1, mainsSamples.begin() + start1 + size1, mains);
+        std::copy (lfeSamples.begin() + start2, lfeSamples.begin() + start2 + size2, lfe + size1);
+        std::copy (mainsSamples.begin() + start2, mainsSamples.begin() + start2 + size2, mains + size1);
+
+        spectrumFifo.finishedRead (size1 + size2);
+        return size1 + size2;
+    }
+
+private:
+    std::atomic<bool> active { false };
+    std::atomic<int> numChannels { 0 };
+    std::atomic<double> sampleRate { 44100.0 };
+
+    Summary current;
+    juce::AbstractFifo summaryFifo { summaryFifoSize };
+    std::array<Summary, (size_t) summaryFifoSize> summaries;
+
+    juce::AbstractFifo spectrumFifo { spectrumFifoSize };
+    std::vector<float> lfeSamples, mainsSamples;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MeterSource)
+};
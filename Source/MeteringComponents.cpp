@@ -0,0 +1,296 @@
+/*
+  ==============================================================================
+
+    Level meters and spectrum analyser drawn by the editor.
+
+  ==============================================================================
+*/
+
+#include "MeteringComponents.h"
+
+//==============================================================================
+LevelMeterComponent::LevelMeterComponent()
+{
+    setOpaque (false);
+}
+
+void LevelMeterComponent::setChannelNames (const juce::StringArray& newNames)
+{
+    if (newNames == names)
+        return;
+
+    names = newNames;
+    channelLevels.assign ((size_t) names.size(), {});
+    repaint();
+}
+
+void LevelMeterComponent::updateLevel (Level& level, float peak, float rms, float fallScale)
+{
+    auto peakDb = juce::Decibels::gainToDecibels (peak, minimumDb);
+    auto rmsDb = juce::Decibels::gainToDecibels (rms, minimumDb);
+
+    level.peakDb = juce::jmax (peakDb, level.peakDb - peakFallDbPerSecond * fallScale, minimumDb);
+    level.rmsDb = juce::jmax (rmsDb, level.rmsDb - rmsFallDbPerSecond * fallScale, minimumDb);
+}
+
+void LevelMeterComponent::update (const MeterSource::Summary& summary, bool hasNewData, double secondsElapsed)
+{
+    auto fallScale = (float) secondsElapsed;
+
+    for (size_t ch = 0; ch < channelLevels.size() && ch < (size_t) MeterSource::maxChannels; ++ch)
+    {
+        if (hasNewData)
+            updateLevel (channelLevels[ch], summary.peak[ch], summary.getRMS ((int) ch), fallScale);
+        else
+            updateLevel (channelLevels[ch], 0.0f, 0.0f, fallScale);
+    }
+
+    if (hasNewData)
+        updateLevel (bassLevel, 0.0f, summary.getBassRMS(), fallScale);
+    else
+        updateLevel (bassLevel, 0.0f, 0.0f, fallScale);
+
+    repaint();
+}
+
+void LevelMeterComponent::drawBar (juce::Graphics& g, juce::Rectangle<float> area, const Level& level,
+                                   const juce::String& name, juce::Colour colour)
+{
+    auto label = area.removeFromBottom (16.0f);
+
+    g.setColour (juce::Colours::white.withAlpha (0.7f));
+    g.setFont (11.0f);
+    g.drawText (name, label, juce::Justification::centred, false);
+
+    g.setColour (juce::Colours::black.withAlpha (0.4f));
+    g.fillRect (area);
+
+    auto proportion = [] (float db) { return juce::jmap (db, minimumDb, maximumDb, 0.0f, 1.0f); };
+
+    g.setColour (colour.withAlpha (0.8f));
+    g.fillRect (area.withTop (area.getBottom() - area.getHeight() * proportion (level.rmsDb)));
+
+    if (level.peakDb > minimumDb)
+    {
+        auto y = area.getBottom() - area.getHeight() * proportion (level.peakDb);
+        g.setColour (level.peakDb > 0.0f ? juce::Colours::red : juce::Colours::white);
+        g.fillRect (area.getX(), y - 1.0f, area.getWidth(), 2.0f);
+    }
+}
+
+void LevelMeterComponent::paint (juce::Graphics& g)
+{
+    auto numBars = (int) channelLevels.size() + 1;
+    auto area = getLocalBounds().toFloat();
+    auto barWidth = area.getWidth() / (float) numBars;
+
+    for (size_t ch = 0; ch < channelLevels.size(); ++ch)
+        drawBar (g, area.removeFromLeft (barWidth).reduced (2.0f, 0.0f), channelLevels[ch],
+                 names[(int) ch], juce::Colours::limegreen);
+
+    drawBar (g, area.reduced (2.0f, 0.0f), bassLevel, "Bass", juce::Colours::orange);
+}
+
+//==============================================================================
+void ProcessingLoadComponent::update (const ProcessingProfiler::Snapshot& snapshot, double silenceSkipRate)
+{
+    auto microseconds = [] (double nanoseconds) { return juce::String (nanoseconds * 0.001, 1) + " us"; };
+
+    lines.clearQuick();
+
+    for (int s = ProcessingProfiler::numStages; --s >= 0;)
+    {
+        auto& stage = snapshot.stages[(size_t) s];
+        auto& before = previous.stages[(size_t) s];
+        auto count = stage.count - before.count;
+        auto mean = count > 0 ? (stage.totalNanoseconds - before.totalNanoseconds) / count : 0.0;
+
+        auto line = juce::String (ProcessingProfiler::getStageName (s)).paddedRight (' ', 20)
+                      + "mean " + microseconds (mean).paddedLeft (' ', 10)
+                      + "   max " + microseconds (stage.maximumNanoseconds).paddedLeft (' ', 10)
+                      + "   overruns " + juce::String (snapshot.overrunsByStage[(size_t) s]);
+
+        if (s == ProcessingProfiler::wholeBlock)
+            line << "   load " << juce::String (100.0 * snapshot.averageLoad, 1) << "%   blocks " << juce::String (snapshot.blocks)
+                 << "   missed deadlines " << juce::String (snapshot.overruns);
+
+        lines.add (line);
+    }
+
+    lines.add (juce::String ("silent channels").paddedRight (' ', 20) + "skipped " + juce::String (100.0 * silenceSkipRate, 1) + "%");
+
+    previous = snapshot;
+    repaint();
+}
+
+void ProcessingLoadComponent::paint (juce::Graphics& g)
+{
+    g.setColour (juce::Colours::white.withAlpha (0.8f));
+    g.setFont (juce::Font (juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+
+    auto area = getLocalBounds();
+
+    for (auto& line : lines)
+        g.drawText (line, area.removeFromTop (16), juce::Justification::centredLeft, false);
+}
+
+//==============================================================================
+SpectrumAnalyserComponent::SpectrumAnalyserComponent()
+    : fftData ((size_t) (2 * fftSize))
+{
+    setOpaque (true);
+
+    for (auto* analysis : { &lfe, &mains })
+    {
+        analysis->history.assign ((size_t) fftSize, 0.0f);
+        analysis->levelsDb.assign ((size_t) fftSize / 2 + 1, minimumDb);
+    }
+}
+
+void SpectrumAnalyserComponent::setSampleRate (double newSampleRate)
+{
+    if (newSampleRate != sampleRate)
+    {
+        sampleRate = newSampleRate;
+        rebuildGrid();
+    }
+}
+
+void SpectrumAnalyserComponent::pushSamples (const float* lfeSamples, const float* mainsSamples, int numSamples)
+{
+    // Only the newest fftSize samples matter
+    auto skip = juce::jmax (0, numSamples - fftSize);
+    auto num = numSamples - skip;
+
+    for (auto [analysis, samples] : { std::pair { &lfe, lfeSamples }, std::pair { &mains, mainsSamples } })
+    {
+        auto& history = analysis->history;
+        std::copy (history.begin() + num, history.end(), history.begin());
+        std::copy (samples + skip, samples + numSamples, history.end() - num);
+    }
+
+    samplesSinceLastFrame += numSamples;
+}
+
+bool SpectrumAnalyserComponent::processIfReady()
+{
+    if (samplesSinceLastFrame < hopSize)
+        return false;
+
+    samplesSinceLastFrame = 0;
+
+    analyse (lfe);
+    analyse (mains);
+    rebuildPath (lfe);
+    rebuildPath (mains);
+    return true;
+}
+
+void SpectrumAnalyserComponent::analyse (Analysis& analysis)
+{
+    std::copy (analysis.history.begin(), analysis.history.end(), fftData.begin());
+    std::fill (fftData.begin() + fftSize, fftData.end(), 0.0f);
+
+    window.multiplyWithWindowingTable (fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform (fftData.data());
+
+    // The window is normalised, so a full-scale sine peaks at fftSize / 2
+    auto scale = 2.0f / (float) fftSize;
+
+    for (size_t bin = 0; bin < analysis.levelsDb.size(); ++bin)
+    {
+        auto db = juce::Decibels::gainToDecibels (fftData[bin] * scale, minimumDb);
+        analysis.levelsDb[bin] = juce::jmax (db, analysis.levelsDb[bin] - fallDbPerFrame);
+    }
+}
+
+void SpectrumAnalyserComponent::rebuildPath (Analysis& analysis) const
+{
+    auto& path = analysis.path;
+    path.clear();
+
+    auto width = getWidth();
+    auto binsPerHz = (float) fftSize / (float) sampleRate;
+    auto lastBin = (float) analysis.levelsDb.size() - 1.0f;
+
+    for (int x = 0; x < width; ++x)
+    {
+        auto frequency = juce::mapToLog10 ((float) x / (float) juce::jmax (1, width - 1), minimumFrequency, maximumFrequency);
+        auto bin = juce::jmin (frequency * binsPerHz, lastBin);
+        auto index = (size_t) bin;
+        auto next = juce::jmin (index + 1, analysis.levelsDb.size() - 1);
+        auto db = juce::jmap (bin - (float) index, analysis.levelsDb[index], analysis.levelsDb[next]);
+        auto y = decibelsToY (db);
+
+        if (x == 0)
+            path.startNewSubPath ((float) x, y);
+        else
+            path.lineTo ((float) x, y);
+    }
+}
+
+void SpectrumAnalyserComponent::rebuildGrid()
+{
+    grid.clear();
+    gridLabels.clear();
+
+    for (auto frequency : { 20.0f, 50.0f, 100.0f, 200.0f, 500.0f, 1000.0f, 2000.0f, 5000.0f, 10000.0f })
+    {
+        auto x = frequencyToX (frequency);
+        grid.startNewSubPath (x, 0.0f);
+        grid.lineTo (x, (float) getHeight());
+        gridLabels.emplace_back (x, frequency >= 1000.0f ? juce::String (juce::roundToInt (frequency / 1000.0f)) + "k"
+                                                         : juce::String (juce::roundToInt (frequency)));
+    }
+
+    for (auto db = maximumDb; db > minimumDb; db -= 15.0f)
+    {
+        auto y = decibelsToY (db);
+        grid.startNewSubPath (0.0f, y);
+        grid.lineTo ((float) getWidth(), y);
+    }
+
+    rebuildPath (lfe);
+    rebuildPath (mains);
+}
+
+float SpectrumAnalyserComponent::frequencyToX (float frequency) const noexcept
+{
+    return juce::mapFromLog10 (frequency, minimumFrequency, maximumFrequency) * (float) getWidth();
+}
+
+float SpectrumAnalyserComponent::decibelsToY (float decibels) const noexcept
+{
+    return juce::jmap (decibels, minimumDb, maximumDb, (float) getHeight(), 0.0f);
+}
+
+void SpectrumAnalyserComponent::resized()
+{
+    rebuildGrid();
+}
+
+void SpectrumAnalyserComponent::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::black);
+
+    g.setColour (juce::Colours::white.withAlpha (0.15f));
+    g.strokePath (grid, juce::PathStrokeType (1.0f));
+
+    g.setColour (juce::Colours::white.withAlpha (0.5f));
+    g.setFont (10.0f);
+
+    for (auto& [x, text] : gridLabels)
+        g.drawText (text, juce::Rectangle<float> (x + 2.0f, (float) getHeight() - 14.0f, 40.0f, 12.0f),
+                    juce::Justification::left, false);
+
+    g.setColour (juce::Colours::limegreen);
+    g.strokePath (mains.path, juce::PathStrokeType (1.5f));
+
+    g.setColour (juce::Colours::orange);
+    g.strokePath (lfe.path, juce::PathStrokeType (1.5f));
+
+    g.drawText ("LFE", getLocalBounds().removeFromTop (16).removeFromRight (80), juce::Justification::centredLeft, false);
+    g.setColour (juce::Colours::limegreen);
+    g.drawText ("Mains", getLocalBounds().removeFromTop (32).removeFromBottom (16).removeFromRight (80),
+                juce::Justification::centredLeft, false);
+}
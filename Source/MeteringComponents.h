@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    Level meters and spectrum analyser drawn by the editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
+
+#include "MeterSource.h"
+#include "ProcessingProfiler.h"
+
+//==============================================================================
+/**
+    Peak and RMS bars for every output channel, plus one for the bass that the
+    crossover redirected from the mains to the LFE.
+
+    The editor feeds it the summaries it drained from the MeterSource once per
+    frame. The bars fall back with fixed ballistics between frames, so the
+    display doesn't depend on the host block size.
+*/
+class LevelMeterComponent  : public juce::Component
+{
+public:
+    LevelMeterComponent();
+
+    void setChannelNames (const juce::StringArray& newNames);
+
+    /** Folds in one frame's worth of summaries; secondsElapsed drives the fall-back. */
+    void update (const MeterSource::Summary& summary, bool hasNewData, double secondsElapsed);
+
+    void paint (juce::Graphics&) override;
+
+private:
+    struct Level
+    {
+        float peakDb = minimumDb, rmsDb = minimumDb;
+    };
+
+    static constexpr float minimumDb = -60.0f;
+    static constexpr float maximumDb = 6.0f;
+    static constexpr float peakFallDbPerSecond = 20.0f;
+    static constexpr float rmsFallDbPerSecond = 40.0f;
+
+    static void updateLevel (Level& level, float peak, float rms, float fallScale);
+    void drawBar (juce::Graphics&, juce::Rectangle<float> area, const Level&, const juce::String& name, juce::Colour);
+
+    juce::StringArray names;
+    std::vector<Level> channelLevels;
+    Level bassLevel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeterComponent)
+};
+
+//==============================================================================
+/**
+    A table of where processBlock spends its time, from ProcessingProfiler
+    snapshots. Means cover the interval since the previous update; maxima and
+    deadline overruns count from the start of the session, as does the share of
+    channel tiles that were skipped for being silent.
+*/
+class ProcessingLoadComponent  : public juce::Component
+{
+public:
+    ProcessingLoadComponent() = default;
+
+    void update (const ProcessingProfiler::Snapshot& snapshot, double silenceSkipRate);
+
+    void paint (juce::Graphics&) override;
+
+private:
+    ProcessingProfiler::Snapshot previous;
+    juce::StringArray lines;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProcessingLoadComponent)
+};
+
+//==============================================================================
+/**
+    A live spectrum of the LFE output against the summed mains.
+
+    Samples arrive from the MeterSource on the message thread. Each frame at most
+    one Hann-windowed FFT per signal is taken, once a hop's worth of new samples
+    has come in, and only then are the two curves rebuilt. paint() just strokes
+    the cached paths over a cached grid.
+*/
+class SpectrumAnalyserComponent  : public juce::Component
+{
+public:
+    static constexpr int fftOrder = 12;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+
+    SpectrumAnalyserComponent();
+
+    void setSampleRate (double newSampleRate);
+
+    /** Appends analyser input; call processIfReady() once per frame afterwards. */
+    void pushSamples (const float* lfe, const float* mains, int numSamples);
+
+    /** Runs the FFTs and rebuilds the curves if a hop has come in. Returns true if it did. */
+    bool processIfReady();
+
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    static constexpr float minimumFrequency = 10.0f;
+    static constexpr float maximumFrequency = 20000.0f;
+    static constexpr float minimumDb = -90.0f;
+    static constexpr float maximumDb = 0.0f;
+    static constexpr float fallDbPerFrame = 1.5f;
+
+    struct Analysis
+    {
+        std::vector<float> history, levelsDb;
+        juce::Path path;
+    };
+
+    void analyse (Analysis&);
+    void rebuildPath (Analysis&) const;
+    void rebuildGrid();
+
+    float frequencyToX (float frequency) const noexcept;
+    float decibelsToY (float decibels) const noexcept;
+
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann };
+    std::vector<float> fftData;
+
+    Analysis lfe, mains;
+    int samplesSinceLastFrame = 0;
+    double sampleRate = 44100.0;
+
+    juce::Path grid;
+    std::vector<std::pair<float, juce::String>> gridLabels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyserComponent)
+};
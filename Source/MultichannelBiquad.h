@@ -0,0 +1,386 @@
+/*
+  ==============================================================================
+
+    A cascade of biquad sections that processes several channels at once.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <numeric>
+
+#include "ChannelLanes.h"
+
+//==============================================================================
+/**
+    Runs the same chain of biquad sections over a group of channels.
+
+    All channel states live in one contiguous block rather than in one
+    IIR::Filter object per channel and section. With SIMD enabled, channels are
+    packed into the lanes of a juce::dsp::SIMDRegister, so a single pass over the
+    block advances SIMDRegister::size() channels together. Without SIMD the
+    channels are walked one at a time.
+
+    process() can be given a list of the channels that need filtering. Only
+    those are packed into lanes, so idle channels cost nothing even when they
+    share a register with busy ones; their samples and state are left alone.
+
+    Cascades of up to maxFixedSections run a kernel instantiated for exactly
+    that many sections, which pushes each sample through every section in one
+    pass with all the states held in registers. The kernel is picked when the
+    section count changes, so the number of sections can be switched at run
+    time (up to the number prepared) without the inner loop ever looking at it.
+
+    Each section is a transposed direct form II biquad; first order sections are
+    stored as biquads with b2 = a2 = 0.
+
+    The coefficients and states are StateType, which can be wider than the
+    samples. Direct form sections with poles close to z = 1, i.e. low cutoffs
+    at high sample rates, need double coefficients and state to stay on their
+    design, so a float signal can be filtered through double lanes.
+*/
+template <typename SampleType, typename StateType = SampleType>
+class MultichannelBiquadCascade
+{
+public:
+    //==============================================================================
+    /** Normalised biquad coefficients (a0 == 1). */
+    struct Section
+    {
+        StateType b0 = 1, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    };
+
+    //==============================================================================
+    MultichannelBiquadCascade() = default;
+
+    /** Allocates the state block. Call this from prepareToPlay, never from the audio thread. */
+    void prepare (int newNumChannels, int newNumSections, int newMaximumBlockSize)
+    {
+        jassert (newNumChannels > 0 && newNumSections > 0 && newMaximumBlockSize > 0);
+
+        numChannels = newNumChannels;
+        maximumBlockSize = newMaximumBlockSize;
+        sections.assign ((size_t) newNumSections, Section {});
+        state.assign ((size_t) (newNumSections * numChannels * 2), StateType (0));
+        setNumSections (newNumSections);
+
+        allChannels.resize ((size_t) numChannels);
+        std::iota (allChannels.begin(), allChannels.end(), 0);
+        activeChannelData.assign ((size_t) numChannels, nullptr);
+
+       #if JUCE_USE_SIMD
+        interleaved.assign ((size_t) maximumBlockSize, Vector::expand (0));
+       #endif
+    }
+
+    /** Clears the filter state of every channel. */
+    void reset() noexcept
+    {
+        std::fill (state.begin(), state.end(), StateType (0));
+    }
+
+    /** True if every section of the channel has a state smaller than threshold, i.e. its
+        output has rung out and a silent input would produce (almost) silence.
+    */
+    bool isChannelStateBelow (int channel, SampleType threshold) const noexcept
+    {
+        for (int section = 0; section < numSections; ++section)
+        {
+            auto* z = state.data() + getStateIndex (section, channel);
+
+            if (std::abs (z[0]) >= threshold || std::abs (z[1]) >= threshold)
+                return false;
+        }
+
+        return true;
+    }
+
+    int getNumChannels() const noexcept     { return numChannels; }
+    int getNumSections() const noexcept     { return numSections; }
+
+    /** Runs only the first newNumSections sections from now on, which must be no more than
+        were prepared. Clears the filter state, as the old state belongs to another filter.
+    */
+    void setNumSections (int newNumSections) noexcept
+    {
+        jassert (newNumSections > 0 && newNumSections <= (int) sections.size());
+
+        numSections = newNumSections;
+        kernel = getKernel (numSections);
+        reset();
+    }
+
+    //==============================================================================
+    /** Sets the coefficients of one section, shared by every channel. */
+    void setSection (int index, const Section& newSection) noexcept
+    {
+        jassert (juce::isPositiveAndBelow (index, getNumSections()));
+        sections[(size_t) index] = newSection;
+    }
+
+    /** Sets one section from a first or second order IIR::Coefficients object. */
+    void setSection (int index, const juce::dsp::IIR::Coefficients<StateType>& coefficients) noexcept
+    {
+        setSection (index, toSection (coefficients));
+    }
+
+    /** Gives every section the same coefficients. */
+    void setAllSections (const Section& newSection) noexcept
+    {
+        std::fill (sections.begin(), sections.end(), newSection);
+    }
+
+    /** Sets every section at once; newSections must hold getNumSections() of them. */
+    void setSections (const Section* newSections) noexcept
+    {
+        std::copy (newSections, newSections + numSections, sections.begin());
+    }
+
+    /** Converts first or second order IIR::Coefficients to a Section. */
+    static Section toSection (const juce::dsp::IIR::Coefficients<StateType>& coefficients) noexcept
+    {
+        auto* c = coefficients.getRawCoefficients();
+
+        if (coefficients.getFilterOrder() == 1)
+            return { c[0], c[1], 0, c[2], 0 };
+
+        jassert (coefficients.getFilterOrder() == 2);
+        return { c[0], c[1], c[2], c[3], c[4] };
+    }
+
+    //==============================================================================
+    /** Filters numSamples of every channel in place.
+
+        channelData must hold getNumChannels() pointers. Blocks longer than the
+        prepared maximum are processed in several passes.
+    */
+    void process (SampleType* const* channelData, int numSamples) noexcept
+    {
+        process (channelData, allChannels.data(), numChannels, numSamples);
+    }
+
+    /** Filters numSamples of only the numActive channels listed in channels, in place.
+        The other channels' samples and state are untouched.
+    */
+    void process (SampleType* const* channelData, const int* channels, int numActive, int numSamples) noexcept
+    {
+        jassert (numActive <= numChannels);
+
+        for (int k = 0; k < numActive; ++k)
+            activeChannelData[(size_t) k] = channelData[channels[k]];
+
+        for (int start = 0; start < numSamples; start += maximumBlockSize)
+        {
+            auto num = juce::jmin (maximumBlockSize, numSamples - start);
+
+            for (int first = 0; first < numActive; first += Lanes::size)
+                (this->*kernel) (channels, first, numActive, start, num);
+        }
+    }
+
+    /** Cascades with up to this many sections get a kernel of their own. */
+    static constexpr int maxFixedSections = 8;
+
+private:
+    //==============================================================================
+    using Lanes = ChannelLanes<StateType>;
+    using Kernel = void (MultichannelBiquadCascade::*) (const int*, int, int, int, int) noexcept;
+
+    int getStateIndex (int section, int channel) const noexcept     { return (section * numChannels + channel) * 2; }
+
+    static Kernel getKernel (int count) noexcept
+    {
+        switch (count)
+        {
+            case 1:     return &MultichannelBiquadCascade::processFixed<1>;
+            case 2:     return &MultichannelBiquadCascade::processFixed<2>;
+            case 3:     return &MultichannelBiquadCascade::processFixed<3>;
+            case 4:     return &MultichannelBiquadCascade::processFixed<4>;
+            case 5:     return &MultichannelBiquadCascade::processFixed<5>;
+            case 6:     return &MultichannelBiquadCascade::processFixed<6>;
+            case 7:     return &MultichannelBiquadCascade::processFixed<7>;
+            case 8:     return &MultichannelBiquadCascade::processFixed<8>;
+            default:    return &MultichannelBiquadCascade::processAny;
+        }
+    }
+
+   #if JUCE_USE_SIMD
+    using Vector = typename Lanes::Vector;
+
+    /** Every sample goes through all NumSections sections before the next one is read. */
+    template <int NumSections>
+    void processFixed (const int* channels, int first, int numActive, int start, int num) noexcept
+    {
+        auto* raw = reinterpret_cast<StateType*> (interleaved.data());
+        Lanes::gather (activeChannelData.data(), first, numActive, start, num, raw);
+
+        auto numLanes = juce::jmin (Lanes::size, numActive - first);
+        Vector b0[NumSections], b1[NumSections], b2[NumSections], a1[NumSections], a2[NumSections];
+        Vector z1[NumSections], z2[NumSections];
+
+        for (int section = 0; section < NumSections; ++section)
+        {
+            auto& s = sections[(size_t) section];
+            b0[section] = Vector::expand (s.b0);
+            b1[section] = Vector::expand (s.b1);
+            b2[section] = Vector::expand (s.b2);
+            a1[section] = Vector::expand (s.a1);
+            a2[section] = Vector::expand (s.a2);
+            z1[section] = Vector::expand (0);
+            z2[section] = Vector::expand (0);
+
+            for (int l = 0; l < numLanes; ++l)
+            {
+                auto* z = state.data() + getStateIndex (section, channels[first + l]);
+                z1[section].set ((size_t) l, z[0]);
+                z2[section].set ((size_t) l, z[1]);
+            }
+        }
+
+        for (int i = 0; i < num; ++i)
+        {
+            auto x = interleaved[(size_t) i];
+
+            for (int section = 0; section < NumSections; ++section)
+            {
+                auto y = b0[section] * x + z1[section];
+                z1[section] = b1[section] * x - a1[section] * y + z2[section];
+                z2[section] = b2[section] * x - a2[section] * y;
+                x = y;
+            }
+
+            interleaved[(size_t) i] = x;
+        }
+
+        for (int section = 0; section < NumSections; ++section)
+        {
+            for (int l = 0; l < numLanes; ++l)
+            {
+                auto* z = state.data() + getStateIndex (section, channels[first + l]);
+                z[0] = z1[section].get ((size_t) l);
+                z[1] = z2[section].get ((size_t) l);
+            }
+        }
+
+        Lanes::scatter (raw, activeChannelData.data(), first, numActive, start, num);
+    }
+
+    /** Any number of sections, one pass over the tile per section. */
+    void processAny (const int* channels, int first, int numActive, int start, int num) noexcept
+    {
+        auto* raw = reinterpret_cast<StateType*> (interleaved.data());
+        Lanes::gather (activeChannelData.data(), first, numActive, start, num, raw);
+
+        auto numLanes = juce::jmin (Lanes::size, numActive - first);
+
+        for (int section = 0; section < numSections; ++section)
+        {
+            auto& s = sections[(size_t) section];
+            auto b0 = Vector::expand (s.b0), b1 = Vector::expand (s.b1), b2 = Vector::expand (s.b2);
+            auto a1 = Vector::expand (s.a1), a2 = Vector::expand (s.a2);
+            auto z1 = Vector::expand (0), z2 = Vector::expand (0);
+
+            // The lanes' states are packed per call, so any channels can share a register
+            for (int l = 0; l < numLanes; ++l)
+            {
+                auto* z = state.data() + getStateIndex (section, channels[first + l]);
+                z1.set ((size_t) l, z[0]);
+                z2.set ((size_t) l, z[1]);
+            }
+
+            for (int i = 0; i < num; ++i)
+            {
+                auto x = interleaved[(size_t) i];
+                auto y = b0 * x + z1;
+                z1 = b1 * x - a1 * y + z2;
+                z2 = b2 * x - a2 * y;
+                interleaved[(size_t) i] = y;
+            }
+
+            for (int l = 0; l < numLanes; ++l)
+            {
+                auto* z = state.data() + getStateIndex (section, channels[first + l]);
+                z[0] = z1.get ((size_t) l);
+                z[1] = z2.get ((size_t) l);
+            }
+        }
+
+        Lanes::scatter (raw, activeChannelData.data(), first, numActive, start, num);
+    }
+
+    std::vector<Vector> interleaved;
+   #else
+    template <int NumSections>
+    void processFixed (const int* channels, int first, int, int start, int num) noexcept
+    {
+        auto* data = activeChannelData[(size_t) first] + start;
+        auto* z = state.data() + getStateIndex (0, channels[first]);
+        StateType z1[NumSections], z2[NumSections];
+
+        for (int section = 0; section < NumSections; ++section)
+        {
+            z1[section] = z[section * numChannels * 2];
+            z2[section] = z[section * numChannels * 2 + 1];
+        }
+
+        for (int i = 0; i < num; ++i)
+        {
+            auto x = static_cast<StateType> (data[i]);
+
+            for (int section = 0; section < NumSections; ++section)
+            {
+                auto& s = sections[(size_t) section];
+                auto y = s.b0 * x + z1[section];
+                z1[section] = s.b1 * x - s.a1 * y + z2[section];
+                z2[section] = s.b2 * x - s.a2 * y;
+                x = y;
+            }
+
+            data[i] = static_cast<SampleType> (x);
+        }
+
+        for (int section = 0; section < NumSections; ++section)
+        {
+            z[section * numChannels * 2] = z1[section];
+            z[section * numChannels * 2 + 1] = z2[section];
+        }
+    }
+
+    void processAny (const int* channels, int first, int, int start, int num) noexcept
+    {
+        auto* data = activeChannelData[(size_t) first] + start;
+        auto* z = state.data() + getStateIndex (0, channels[first]);
+
+        for (int section = 0; section < numSections; ++section)
+        {
+            auto& s = sections[(size_t) section];
+            auto z1 = z[0], z2 = z[1];
+
+            for (int i = 0; i < num; ++i)
+            {
+                auto x = static_cast<StateType> (data[i]);
+                auto y = s.b0 * x + z1;
+                z1 = s.b1 * x - s.a1 * y + z2;
+                z2 = s.b2 * x - s.a2 * y;
+                data[i] = static_cast<SampleType> (y);
+            }
+
+            z[0] = z1;
+            z[1] = z2;
+            z += numChannels * 2;
+        }
+    }
+   #endif
+
+    std::vector<StateType> state;
+    std::vector<int> allChannels;
+    std::vector<SampleType*> activeChannelData;
+    std::vector<Section> sections;
+    Kernel kernel = nullptr;
+    int numChannels = 0, numSections = 0, maximumBlockSize = 0;
+
+    JUCE_LEAK_DETECTOR (MultichannelBiquadCascade)
+};
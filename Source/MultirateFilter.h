@@ -0,0 +1,342 @@
+/*
+  ==============================================================================
+
+    Polyphase half-band decimation and interpolation chains.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+//==============================================================================
+/**
+    Coefficients of a symmetric half-band FIR.
+
+    A half-band filter of length 4M - 1 has its centre tap at 0.5 and every other
+    tap at zero, so only the M odd-offset taps g[j] (offsets +-(2j + 1) from the
+    centre) are stored. The design is a Blackman-windowed sinc whose length is
+    chosen from the width of the transition band the stage can afford.
+*/
+struct HalfBandCoefficients
+{
+    /** Designs a half-band that keeps content below passbandFrequency at inputSampleRate. */
+    void design (double inputSampleRate, double passbandFrequency)
+    {
+        // Normalised transition width; the band is symmetric about fs / 4
+        auto transition = juce::jmax (0.05, 0.5 - 2.0 * passbandFrequency / inputSampleRate);
+        auto numTaps = 5.5 / transition;
+        auto m = juce::jmax (2, (int) std::ceil ((numTaps + 1.0) / 4.0));
+
+        auto length = 4 * m - 1;
+        auto centre = 2 * m - 1;
+        auto pi = juce::MathConstants<double>::pi;
+
+        taps.resize ((size_t) m);
+        double sum = 0.0;
+
+        for (int j = 0; j < m; ++j)
+        {
+            auto offset = 2 * j + 1;
+            auto n = (double) (centre + offset);
+            auto window = 0.42 - 0.5 * std::cos (2.0 * pi * n / (length - 1))
+                               + 0.08 * std::cos (4.0 * pi * n / (length - 1));
+            auto sign = (j % 2 == 0) ? 1.0 : -1.0;
+
+            taps[(size_t) j] = sign / (pi * offset) * window;
+            sum += taps[(size_t) j];
+        }
+
+        // Unity gain at DC: 0.5 + 2 * sum (g) == 1
+        for (auto& t : taps)
+            t *= 0.25 / sum;
+    }
+
+    int getNumTaps() const noexcept       { return (int) taps.size(); }
+    int getCentre() const noexcept        { return 2 * getNumTaps() - 1; }
+
+    std::vector<double> taps;
+};
+
+/** Number of half-band stages that keeps the reduced rate at or above minimumRate. */
+inline int getNumHalfBandStages (double sampleRate, double minimumRate) noexcept
+{
+    int numStages = 0;
+
+    while (sampleRate * 0.5 >= minimumRate)
+    {
+        sampleRate *= 0.5;
+        ++numStages;
+    }
+
+    return numStages;
+}
+
+//==============================================================================
+/**
+    Decimates by 2^N through a chain of half-band stages.
+
+    Each stage only evaluates its output on every second input sample and
+    exploits the zero taps and symmetry of the half-band, so the work per input
+    sample is roughly M / 2 multiplies.
+*/
+template <typename SampleType>
+class MultirateDecimator
+{
+public:
+    /** Allocates every stage. passbandFrequency is the highest frequency that must survive. */
+    void prepare (double sampleRate, int numStagesToUse, double passbandFrequency)
+    {
+        stages.resize ((size_t) numStagesToUse);
+        auto rate = sampleRate;
+
+        for (auto& stage : stages)
+        {
+            stage.prepare (rate, passbandFrequency);
+            rate *= 0.5;
+        }
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& stage : stages)
+            stage.reset();
+    }
+
+    int getNumStages() const noexcept             { return (int) stages.size(); }
+    int getFactor() const noexcept                { return 1 << getNumStages(); }
+
+    /** Group delay of the chain, in samples at the input rate. */
+    int getLatencyInSamples() const noexcept
+    {
+        int latency = 0;
+
+        for (int s = 0; s < getNumStages(); ++s)
+            latency += stages[(size_t) s].coefficients.getCentre() << s;
+
+        return latency;
+    }
+
+    /** Consumes numSamples inputs and writes the decimated samples to output.
+        Returns how many low-rate samples were produced.
+    */
+    int process (const SampleType* input, int numSamples, SampleType* output) noexcept
+    {
+        int numOut = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto sample = input[i];
+            auto produced = true;
+
+            for (auto& stage : stages)
+            {
+                if (! stage.push (sample))
+                {
+                    produced = false;
+                    break;
+                }
+            }
+
+            if (produced)
+                output[numOut++] = sample;
+        }
+
+        return numOut;
+    }
+
+private:
+    struct Stage
+    {
+        void prepare (double rate, double passband)
+        {
+            coefficients.design (rate, passband);
+            length = 4 * coefficients.getNumTaps() - 1;
+            history.assign ((size_t) (2 * length), SampleType (0));
+            taps.assign (coefficients.taps.begin(), coefficients.taps.end());
+        }
+
+        void reset() noexcept
+        {
+            std::fill (history.begin(), history.end(), SampleType (0));
+            position = 0;
+            phase = false;
+        }
+
+        /** Pushes one input; returns true and overwrites sample when an output is due. */
+        bool push (SampleType& sample) noexcept
+        {
+            position = (position == 0 ? length : position) - 1;
+            history[(size_t) position] = history[(size_t) (position + length)] = sample;
+
+            phase = ! phase;
+
+            if (phase)
+                return false;
+
+            // x[t - k] == window[k]
+            auto* window = history.data() + position;
+            auto centre = coefficients.getCentre();
+            auto y = SampleType (0.5) * window[centre];
+
+            for (size_t j = 0; j < taps.size(); ++j)
+            {
+                auto offset = (int) (2 * j + 1);
+                y += taps[j] * (window[centre - offset] + window[centre + offset]);
+            }
+
+            sample = y;
+            return true;
+        }
+
+        HalfBandCoefficients coefficients;
+        std::vector<SampleType> history, taps;
+        int length = 0, position = 0;
+        bool phase = false;
+    };
+
+    std::vector<Stage> stages;
+
+    JUCE_LEAK_DETECTOR (MultirateDecimator)
+};
+
+//==============================================================================
+/**
+    Interpolates by 2^N through a chain of half-band stages.
+
+    The polyphase split leaves one branch that is a pure delay, so each stage
+    costs M multiplies per input sample. Because a low-rate sample is only ready
+    once 2^N inputs have been decimated, the output passes through a small FIFO
+    primed with 2^N - 1 samples. That is exactly how long a decimated sample
+    waits for its group to complete, so any host block size works and the FIFO
+    adds nothing to the latency beyond the filters' group delay.
+*/
+template <typename SampleType>
+class MultirateInterpolator
+{
+public:
+    void prepare (double sampleRate, int numStagesToUse, double passbandFrequency, int maximumBlockSize)
+    {
+        stages.resize ((size_t) numStagesToUse);
+        auto rate = sampleRate;
+
+        for (auto& stage : stages)
+        {
+            stage.prepare (rate, passbandFrequency);
+            rate *= 0.5;
+        }
+
+        fifo.assign ((size_t) juce::nextPowerOfTwo (maximumBlockSize + 2 * getFactor()), SampleType (0));
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& stage : stages)
+            stage.reset();
+
+        std::fill (fifo.begin(), fifo.end(), SampleType (0));
+        readPosition = 0;
+        numReady = getFactor() - 1;
+        writePosition = numReady;
+    }
+
+    int getNumStages() const noexcept             { return (int) stages.size(); }
+    int getFactor() const noexcept                { return 1 << getNumStages(); }
+
+    /** Group delay of the chain, in samples at the output rate. */
+    int getLatencyInSamples() const noexcept
+    {
+        int latency = 0;
+
+        for (int s = 0; s < getNumStages(); ++s)
+            latency += stages[(size_t) s].coefficients.getCentre() << s;
+
+        return latency;
+    }
+
+    /** Interpolates numInput low-rate samples, then writes numOutput samples to output. */
+    void process (const SampleType* input, int numInput, SampleType* output, int numOutput) noexcept
+    {
+        for (int i = 0; i < numInput; ++i)
+            interpolate (input[i], getNumStages() - 1);
+
+        jassert (numReady >= numOutput);
+
+        auto mask = (int) fifo.size() - 1;
+
+        for (int i = 0; i < numOutput; ++i)
+        {
+            output[i] = fifo[(size_t) readPosition];
+            readPosition = (readPosition + 1) & mask;
+        }
+
+        numReady -= numOutput;
+    }
+
+private:
+    void interpolate (SampleType sample, int stageIndex) noexcept
+    {
+        if (stageIndex < 0)
+        {
+            fifo[(size_t) writePosition] = sample;
+            writePosition = (writePosition + 1) & ((int) fifo.size() - 1);
+            ++numReady;
+            return;
+        }
+
+        SampleType even, odd;
+        stages[(size_t) stageIndex].push (sample, even, odd);
+
+        interpolate (even, stageIndex - 1);
+        interpolate (odd, stageIndex - 1);
+    }
+
+    struct Stage
+    {
+        void prepare (double outputRate, double passband)
+        {
+            coefficients.design (outputRate, passband);
+            length = 2 * coefficients.getNumTaps();
+            history.assign ((size_t) (2 * length), SampleType (0));
+            taps.assign (coefficients.taps.begin(), coefficients.taps.end());
+        }
+
+        void reset() noexcept
+        {
+            std::fill (history.begin(), history.end(), SampleType (0));
+            position = 0;
+        }
+
+        /** Pushes one input and produces the two output samples it spans. */
+        void push (SampleType sample, SampleType& even, SampleType& odd) noexcept
+        {
+            position = (position == 0 ? length : position) - 1;
+            history[(size_t) position] = history[(size_t) (position + length)] = sample;
+
+            // x[m - i] == window[i]; even taps pair up symmetrically around the centre
+            auto* window = history.data() + position;
+            auto m = coefficients.getNumTaps();
+            SampleType y = 0;
+
+            for (int j = 0; j < m; ++j)
+                y += taps[(size_t) j] * (window[m - 1 - j] + window[m + j]);
+
+            even = SampleType (2) * y;
+            odd = window[m - 1];
+        }
+
+        HalfBandCoefficients coefficients;
+        std::vector<SampleType> history, taps;
+        int length = 0, position = 0;
+    };
+
+    std::vector<Stage> stages;
+    std::vector<SampleType> fifo;
+    int readPosition = 0, writePosition = 0, numReady = 0;
+
+    JUCE_LEAK_DETECTOR (MultirateInterpolator)
+};
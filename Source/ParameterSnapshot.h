@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    The plugin parameters as one plain struct, with a note of what changed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "ChannelMap.h"
+#include "CoefficientTable.h"
+#include "PartitionedConvolution.h"
+
+enum class CrossoverTopology { biquad, stateVariable, linearPhase };
+
+/** The parameter values one block is processed with. */
+struct BassManagementParameters
+{
+    /** One bit per value, for the changed mask. */
+    enum Field : juce::uint32
+    {
+        crossoverFrequencyField       = 1 << 0,
+        lfeLowPassFrequencyField      = 1 << 1,
+        lfeBoostField                 = 1 << 2,
+        multirateField                = 1 << 3,
+        topologyField                 = 1 << 4,
+        linearPhasePartitionSizeField = 1 << 5,
+        slopeField                    = 1 << 6,
+        channelDelaysField            = 1 << 7,
+        channelTrimsField             = 1 << 8,
+        subwoofersField               = 1 << 9,
+        lfeLimiterField               = 1 << 10,
+        parallelChannelsField         = 1 << 11,
+
+        allFields = (1 << 12) - 1
+    };
+
+    float crossoverFrequency = 60.0f, lfeLowPassFrequency = 120.0f;
+    bool lfeBoost = false, multirate = false;
+    CrossoverTopology topology = CrossoverTopology::biquad;
+    CrossoverSlope slope = CrossoverSlope::classic;
+    int linearPhasePartitionSize = 256;
+
+    /** Per output channel, in the layout's channel order: delay in milliseconds and trim in dB. */
+    std::array<float, BassManagementChannelMap::maxChannels> channelDelays {}, channelTrims {};
+
+    /** Per subwoofer feed: gain in dB, polarity, delay in milliseconds and low-pass cutoff. */
+    std::array<float, BassManagementChannelMap::maxSubwoofers> subwooferGains {}, subwooferDelays {};
+    std::array<bool, BassManagementChannelMap::maxSubwoofers> subwooferInverts {};
+    std::array<float, BassManagementChannelMap::maxSubwoofers> subwooferLowPassFrequencies { 250.0f, 250.0f, 250.0f, 250.0f };
+
+    /** The true-peak limiter on the LFE and subwoofer outputs, and its ceiling in dB. */
+    bool lfeLimiter = false;
+    float lfeLimiterCeiling = -1.0f;
+
+    /** Spread the mains' high-passes over worker threads, for very wide layouts. */
+    bool parallelChannels = false;
+
+    /** The fields that differ from the previous snapshot. Values built by hand count as all new. */
+    juce::uint32 changed = allFields;
+
+    bool hasChanged (juce::uint32 fields) const noexcept     { return (changed & fields) != 0; }
+};
+
+//==============================================================================
+/**
+    Publishes the APVTS parameters to the audio thread as a BassManagementParameters.
+
+    The parameters' atomics are looked up by ID once, on construction, so the
+    audio thread never builds an ID string or searches the value tree. Each
+    update() reads every atomic, converts the raw values (choice index to
+    partition size and so on) and marks the fields that differ from the last
+    update, so the engine only redesigns filters and recomputes gains for
+    parameters that actually moved.
+
+    update() belongs to the audio thread, or to prepareToPlay while the audio
+    thread is stopped. It doesn't allocate or lock.
+*/
+class ParameterSnapshot
+{
+public:
+    explicit ParameterSnapshot (juce::AudioProcessorValueTreeState& state)
+        : crossoverFrequency (getParameter (state, "crossoverFrequency")),
+          lfeLowPassFrequency (getParameter (state, "lfeLowPassFrequency")),
+          lfeBoost (getParameter (state, "lfeBoost")),
+          multirate (getParameter (state, "multiRate")),
+          topology (getParameter (state, "crossoverTopology")),
+          linearPhasePartition (getParameter (state, "linearPhasePartition")),
+          slope (getParameter (state, "crossoverSlope")),
+          lfeLimiter (getParameter (state, "lfeLimiter")),
+          lfeLimiterCeiling (getParameter (state, "lfeLimiterCeiling")),
+          parallelChannels (getParameter (state, "parallelChannels"))
+    {
+        for (int ch = 0; ch < BassManagementChannelMap::maxChannels; ++ch)
+        {
+            channelDelays[(size_t) ch] = &getParameter (state, "channelDelay" + juce::String (ch + 1));
+            channelTrims[(size_t) ch] = &getParameter (state, "channelTrim" + juce::String (ch + 1));
+        }
+
+        for (int sub = 0; sub < BassManagementChannelMap::maxSubwoofers; ++sub)
+        {
+            auto number = juce::String (sub + 1);
+            subwooferGains[(size_t) sub] = &getParameter (state, "subwooferGain" + number);
+            subwooferInverts[(size_t) sub] = &getParameter (state, "subwooferInvert" + number);
+            subwooferDelays[(size_t) sub] = &getParameter (state, "subwooferDelay" + number);
+            subwooferLowPassFrequencies[(size_t) sub] = &getParameter (state, "subwooferLowPass" + number);
+        }
+    }
+
+    /** Reads every parameter and marks the fields that changed since the previous call. */
+    const BassManagementParameters& update() noexcept
+    {
+        auto previous = values;
+
+        values.crossoverFrequency = crossoverFrequency.load();
+        values.lfeLowPassFrequency = lfeLowPassFrequency.load();
+        values.lfeBoost = lfeBoost.load() > 0.5f;
+        values.multirate = multirate.load() > 0.5f;
+        values.topology = static_cast<CrossoverTopology> (juce::roundToInt (topology.load()));
+        values.linearPhasePartitionSize = PartitionedConvolution::minimumPartitionSize << juce::roundToInt (linearPhasePartition.load());
+        values.slope = static_cast<CrossoverSlope> (juce::roundToInt (slope.load()));
+
+        for (size_t ch = 0; ch < channelDelays.size(); ++ch)
+        {
+            values.channelDelays[ch] = channelDelays[ch]->load();
+            values.channelTrims[ch] = channelTrims[ch]->load();
+        }
+
+        for (size_t sub = 0; sub < subwooferGains.size(); ++sub)
+        {
+            values.subwooferGains[sub] = subwooferGains[sub]->load();
+            values.subwooferInverts[sub] = subwooferInverts[sub]->load() > 0.5f;
+            values.subwooferDelays[sub] = subwooferDelays[sub]->load();
+            values.subwooferLowPassFrequencies[sub] = subwooferLowPassFrequencies[sub]->load();
+        }
+
+        values.lfeLimiter = lfeLimiter.load() > 0.5f;
+        values.lfeLimiterCeiling = lfeLimiterCeiling.load();
+        values.parallelChannels = parallelChannels.load() > 0.5f;
+
+        // The very first update reports everything, there is nothing to compare against
+        values.changed = hasUpdated ? getChangedFields (previous, values)
+                                    : (juce::uint32) BassManagementParameters::allFields;
+        hasUpdated = true;
+
+        return values;
+    }
+
+private:
+    static std::atomic<float>& getParameter (juce::AudioProcessorValueTreeState& state, const juce::String& parameterID)
+    {
+        auto* value = state.getRawParameterValue (parameterID);
+        jassert (value != nullptr);
+        return *value;
+    }
+
+    static juce::uint32 getChangedFields (const BassManagementParameters& a, const BassManagementParameters& b) noexcept
+    {
+        using P = BassManagementParameters;
+
+        return (a.crossoverFrequency != b.crossoverFrequency             ? P::crossoverFrequencyField : 0u)
+             | (a.lfeLowPassFrequency != b.lfeLowPassFrequency           ? P::lfeLowPassFrequencyField : 0u)
+             | (a.lfeBoost != b.lfeBoost                                 ? P::lfeBoostField : 0u)
+             | (a.multirate != b.multirate                               ? P::multirateField : 0u)
+             | (a.topology != b.topology                                 ? P::topologyField : 0u)
+             | (a.linearPhasePartitionSize != b.linearPhasePartitionSize ? P::linearPhasePartitionSizeField : 0u)
+             | (a.slope != b.slope                                       ? P::slopeField : 0u)
+             | (a.channelDelays != b.channelDelays                       ? P::channelDelaysField : 0u)
+             | (a.channelTrims != b.channelTrims                         ? P::channelTrimsField : 0u)
+             | (a.subwooferGains != b.subwooferGains
+                 || a.subwooferInverts != b.subwooferInverts
+                 || a.subwooferDelays != b.subwooferDelays
+                 || a.subwooferLowPassFrequencies != b.subwooferLowPassFrequencies ? P::subwoofersField : 0u)
+             | (a.lfeLimiter != b.lfeLimiter || a.lfeLimiterCeiling != b.lfeLimiterCeiling ? P::lfeLimiterField : 0u)
+             | (a.parallelChannels != b.parallelChannels                 ? P::parallelChannelsField : 0u);
+    }
+
+    std::atomic<float>& crossoverFrequency;
+    std::atomic<float>& lfeLowPassFrequency;
+    std::atomic<float>& lfeBoost;
+    std::atomic<float>& multirate;
+    std::atomic<float>& topology;
+    std::atomic<float>& linearPhasePartition;
+    std::atomic<float>& slope;
+    std::atomic<float>& lfeLimiter;
+    std::atomic<float>& lfeLimiterCeiling;
+    std::atomic<float>& parallelChannels;
+    std::array<std::atomic<float>*, BassManagementChannelMap::maxChannels> channelDelays {}, channelTrims {};
+    std::array<std::atomic<float>*, BassManagementChannelMap::maxSubwoofers> subwooferGains {}, subwooferInverts {},
+                                                                             subwooferDelays {}, subwooferLowPassFrequencies {};
+
+    BassManagementParameters values;
+    bool hasUpdated = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterSnapshot)
+};
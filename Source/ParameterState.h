@@ -0,0 +1,119 @@
+/*
+  ==============================================================================
+
+    The plugin state as a compact, versioned binary blob.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <cstring>
+
+//==============================================================================
+/**
+    Saves and recalls every parameter without going through XML.
+
+    The blob is a three-word header (magic, format version, number of values)
+    followed by each parameter's plain value as a little-endian float, in the
+    order the parameters were created. Writing is one pass over the parameters
+    into a buffer of known size, and reading is one pass setting each parameter
+    straight from its float: no ValueTree is built and no text is parsed. The
+    parameters update the processor's ParameterSnapshot atomics as they are
+    set, so the next block already runs with the recalled values.
+
+    New parameters must only ever be added at the end of the layout. A state
+    from an older build then simply has fewer values, and the parameters it
+    doesn't know about go back to their defaults, as they would with an XML
+    state. The version only goes up if an existing value changes its meaning;
+    states from a newer version are refused rather than misread.
+*/
+struct BinaryParameterState
+{
+    /** "BMst" as a little-endian word. JUCE's XML blobs start with a different magic number. */
+    static constexpr juce::uint32 magic = 0x74734d42;
+    static constexpr juce::uint32 currentVersion = 1;
+    static constexpr int headerSize = 3 * (int) sizeof (juce::uint32);
+
+    /** True if data starts with a binary state header of any version. */
+    static bool isBinaryState (const void* data, int sizeInBytes) noexcept
+    {
+        return sizeInBytes >= headerSize && readWord (data, 0) == magic;
+    }
+
+    /** Replaces the contents of destData with the current values of parameters. */
+    template <typename ParameterArray>
+    static void write (const ParameterArray& parameters, juce::MemoryBlock& destData)
+    {
+        auto numValues = (int) parameters.size();
+        destData.setSize ((size_t) (headerSize + numValues * (int) sizeof (float)));
+
+        auto* data = destData.getData();
+        writeWord (data, 0, magic);
+        writeWord (data, 1, currentVersion);
+        writeWord (data, 2, (juce::uint32) numValues);
+
+        for (int i = 0; i < numValues; ++i)
+        {
+            auto* parameter = parameters[(size_t) i];
+            auto value = parameter->convertFrom0to1 (parameter->getValue());
+
+            juce::uint32 bits;
+            std::memcpy (&bits, &value, sizeof (bits));
+            writeWord (data, 3 + i, bits);
+        }
+    }
+
+    /** Sets parameters from a binary state. Returns false, changing nothing, if the data
+        is truncated or from a newer format version.
+    */
+    template <typename ParameterArray>
+    static bool read (const void* data, int sizeInBytes, const ParameterArray& parameters)
+    {
+        if (! isBinaryState (data, sizeInBytes) || readWord (data, 1) > currentVersion)
+            return false;
+
+        auto numValues = (int) readWord (data, 2);
+
+        if (numValues < 0 || (sizeInBytes - headerSize) / (int) sizeof (float) < numValues)
+            return false;
+
+        for (int i = 0; i < (int) parameters.size(); ++i)
+        {
+            auto* parameter = parameters[(size_t) i];
+            auto normalised = parameter->getDefaultValue();
+
+            if (i < numValues)
+            {
+                auto bits = readWord (data, 3 + i);
+                float value;
+                std::memcpy (&value, &bits, sizeof (value));
+
+                if (std::isfinite (value))
+                    normalised = parameter->convertTo0to1 (value);
+            }
+
+            // Only parameters that actually move notify the host and the snapshot
+            if (normalised != parameter->getValue())
+                parameter->setValueNotifyingHost (normalised);
+        }
+
+        return true;
+    }
+
+private:
+    static juce::uint32 readWord (const void* data, int index) noexcept
+    {
+        juce::uint32 word;
+        std::memcpy (&word, static_cast<const char*> (data) + index * (int) sizeof (word), sizeof (word));
+        return juce::ByteOrder::swapIfBigEndian (word);
+    }
+
+    static void writeWord (void* data, int index, juce::uint32 word) noexcept
+    {
+        word = juce::ByteOrder::swapIfBigEndian (word);
+        std::memcpy (static_cast<char*> (data) + index * (int) sizeof (word), &word, sizeof (word));
+    }
+};
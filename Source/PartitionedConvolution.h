@@ -0,0 +1,371 @@
+/*
+  ==============================================================================
+
+    Uniformly partitioned FFT convolution over a group of channels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <atomic>
+
+//==============================================================================
+/**
+    Convolves several channels with one long impulse response using uniformly
+    partitioned overlap-save convolution.
+
+    The impulse response is cut into partitions of P samples and each partition's
+    spectrum is kept. Every P input samples, each channel's newest 2P samples are
+    transformed once, pushed into a frequency-domain delay line, multiplied with
+    all the partition spectra and accumulated, and then transformed back. The
+    channels share the filter spectra and the FFT scratch, and only keep their
+    own delay line and input history. Output is delayed by exactly P samples.
+
+    prepare() allocates enough for every partition size between
+    minimumPartitionSize and maximumPartitionSize, so setPartitionSize() and
+    setImpulseResponse() never allocate and can be called on the audio thread.
+    The partition spectra are stored as separate real and imaginary arrays so the
+    multiply-accumulate loop vectorises.
+
+    A new impulse response can also be handed over from another thread with
+    setNextImpulseResponse(), which does the transforms on that thread. The next
+    partition is then convolved with both responses and faded from the old one
+    to the new one, so retuning while playing neither clicks nor costs the audio
+    thread more than one extra multiply-accumulate and inverse FFT.
+*/
+class PartitionedConvolution
+{
+public:
+    static constexpr int minimumPartitionOrder = 6;
+    static constexpr int maximumPartitionOrder = 10;
+    static constexpr int minimumPartitionSize = 1 << minimumPartitionOrder;
+    static constexpr int maximumPartitionSize = 1 << maximumPartitionOrder;
+
+    /** Allocates everything for numChannels and impulse responses up to maximumImpulseLength. */
+    void prepare (int newNumChannels, int newMaximumImpulseLength)
+    {
+        jassert (newNumChannels > 0 && newMaximumImpulseLength > 0);
+
+        numChannels = newNumChannels;
+        maximumImpulseLength = newMaximumImpulseLength;
+
+        ffts.clear();
+        nextFfts.clear();
+
+        // The next response is transformed with FFTs of its own, so that can run alongside process()
+        for (int order = minimumPartitionOrder; order <= maximumPartitionOrder; ++order)
+        {
+            ffts.push_back (std::make_unique<juce::dsp::FFT> (order + 1));
+            nextFfts.push_back (std::make_unique<juce::dsp::FFT> (order + 1));
+        }
+
+        // The spectra need the most room with the smallest partitions
+        size_t spectrumCapacity = 0;
+
+        for (int size = minimumPartitionSize; size <= maximumPartitionSize; size *= 2)
+            spectrumCapacity = juce::jmax (spectrumCapacity, (size_t) (getNumPartitions (size) * (size + 1)));
+
+        for (auto& response : responses)
+        {
+            response.impulse.assign ((size_t) maximumImpulseLength, 0.0f);
+            response.real.assign (spectrumCapacity, 0.0f);
+            response.imag.assign (spectrumCapacity, 0.0f);
+            response.length = 1;
+        }
+
+        current = &responses[0];
+        next = &responses[1];
+        hasNext = false;
+
+        delayLineReal.assign (spectrumCapacity * (size_t) numChannels, 0.0f);
+        delayLineImag.assign (spectrumCapacity * (size_t) numChannels, 0.0f);
+        accumulatorReal.assign ((size_t) maximumPartitionSize + 1, 0.0f);
+        accumulatorImag.assign ((size_t) maximumPartitionSize + 1, 0.0f);
+        inputHistory.assign ((size_t) (2 * maximumPartitionSize * numChannels), 0.0f);
+        outputFifo.assign ((size_t) (maximumPartitionSize * numChannels), 0.0f);
+        crossfade.assign ((size_t) maximumPartitionSize, 0.0f);
+        scratch.assign ((size_t) (4 * maximumPartitionSize), 0.0f);
+        nextScratch.assign ((size_t) (4 * maximumPartitionSize), 0.0f);
+
+        partitionSize = 0;
+        setPartitionSize (256);
+    }
+
+    int getNumChannels() const noexcept             { return numChannels; }
+    int getPartitionSize() const noexcept           { return partitionSize; }
+    int getLatencyInSamples() const noexcept        { return partitionSize; }
+
+    /** Changes the partition size, a power of two between the minimum and maximum.
+        This clears the channel state, as reset() does.
+    */
+    void setPartitionSize (int newPartitionSize) noexcept
+    {
+        jassert (juce::isPowerOfTwo (newPartitionSize));
+        newPartitionSize = juce::jlimit (minimumPartitionSize, maximumPartitionSize, newPartitionSize);
+
+        if (newPartitionSize == partitionSize)
+            return;
+
+        partitionSize = newPartitionSize;
+        numBins = partitionSize + 1;
+        fft = getFFT (ffts, partitionSize);
+        latestPartitionSize.store (partitionSize, std::memory_order_relaxed);
+
+        // The state is cleared anyway, so a waiting response is taken over without a fade
+        if (hasNext.load (std::memory_order_acquire))
+            takeOverNext();
+
+        partitionImpulse (*current, partitionSize, *fft, scratch);
+        reset();
+    }
+
+    /** Replaces the impulse response; the channel state is kept, so the change takes
+        effect on the next partition without a gap.
+    */
+    void setImpulseResponse (const float* newImpulse, int length) noexcept
+    {
+        jassert (length > 0 && length <= maximumImpulseLength);
+
+        current->length = juce::jmin (length, maximumImpulseLength);
+        std::copy (newImpulse, newImpulse + current->length, current->impulse.begin());
+        partitionImpulse (*current, partitionSize, *fft, scratch);
+    }
+
+    /** Prepares a new impulse response on the calling thread for process() to fade to
+        over its next partition. Meant for a thread other than the audio thread, and only
+        one at a time; it never blocks process(). Does nothing while
+        hasNextImpulseResponse() is still true.
+    */
+    void setNextImpulseResponse (const float* newImpulse, int length) noexcept
+    {
+        jassert (length > 0 && length <= maximumImpulseLength);
+
+        if (hasNextImpulseResponse())
+        {
+            jassertfalse;
+            return;
+        }
+
+        auto size = latestPartitionSize.load (std::memory_order_relaxed);
+        next->length = juce::jmin (length, maximumImpulseLength);
+        std::copy (newImpulse, newImpulse + next->length, next->impulse.begin());
+        partitionImpulse (*next, size, *getFFT (nextFfts, size), nextScratch);
+
+        hasNext.store (true, std::memory_order_release);
+    }
+
+    /** True from setNextImpulseResponse() until process() has taken the new response over. */
+    bool hasNextImpulseResponse() const noexcept     { return hasNext.load (std::memory_order_acquire); }
+
+    void reset() noexcept
+    {
+        std::fill (delayLineReal.begin(), delayLineReal.end(), 0.0f);
+        std::fill (delayLineImag.begin(), delayLineImag.end(), 0.0f);
+        std::fill (inputHistory.begin(), inputHistory.end(), 0.0f);
+        std::fill (outputFifo.begin(), outputFifo.end(), 0.0f);
+        fifoPosition = 0;
+        delayLinePosition = 0;
+    }
+
+    /** Convolves numSamples of every channel in place; channelData must hold getNumChannels() pointers. */
+    void process (float* const* channelData, int numSamples) noexcept
+    {
+        for (int done = 0; done < numSamples;)
+        {
+            auto num = juce::jmin (numSamples - done, partitionSize - fifoPosition);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* data = channelData[ch] + done;
+                auto* input = getInputHistory (ch) + partitionSize + fifoPosition;
+                auto* output = getOutputFifo (ch) + fifoPosition;
+
+                std::copy (data, data + num, input);
+                std::copy (output, output + num, data);
+            }
+
+            fifoPosition += num;
+            done += num;
+
+            if (fifoPosition == partitionSize)
+            {
+                processPartition();
+                fifoPosition = 0;
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    int getNumPartitions (int size) const noexcept    { return (maximumImpulseLength + size - 1) / size; }
+    int getNumPartitions() const noexcept             { return getNumPartitions (partitionSize); }
+
+    float* getInputHistory (int channel) noexcept     { return inputHistory.data() + 2 * partitionSize * channel; }
+    float* getOutputFifo (int channel) noexcept       { return outputFifo.data() + partitionSize * channel; }
+
+    /** An impulse response and its partitions' spectra at one partition size. */
+    struct Response
+    {
+        std::vector<float> impulse, real, imag;
+        int length = 1, partitionSize = 0;
+    };
+
+    static juce::dsp::FFT* getFFT (const std::vector<std::unique_ptr<juce::dsp::FFT>>& transforms, int size) noexcept
+    {
+        return transforms[(size_t) (juce::roundToInt (std::log2 (size)) - minimumPartitionOrder)].get();
+    }
+
+    void partitionImpulse (Response& response, int size, const juce::dsp::FFT& transform, std::vector<float>& work) const noexcept
+    {
+        auto bins = size + 1;
+        response.partitionSize = size;
+
+        for (int p = 0; p < getNumPartitions (size); ++p)
+        {
+            std::fill (work.begin(), work.end(), 0.0f);
+
+            auto start = p * size;
+            auto num = juce::jlimit (0, size, response.length - start);
+
+            if (num > 0)
+                std::copy (response.impulse.data() + start, response.impulse.data() + start + num, work.data());
+
+            transform.performRealOnlyForwardTransform (work.data(), true);
+            deinterleave (work, bins, response.real.data() + p * bins, response.imag.data() + p * bins);
+        }
+    }
+
+    void takeOverNext() noexcept
+    {
+        std::swap (current, next);
+        hasNext.store (false, std::memory_order_release);
+    }
+
+    void processPartition() noexcept
+    {
+        auto numPartitions = getNumPartitions();
+        auto spectrumSize = (size_t) (numPartitions * numBins);
+
+        // A response from setNextImpulseResponse() takes over here, faded in across this
+        // partition's output. One prepared before the partition size last changed is
+        // re-cut instead; the state was cleared then, so it needs no fade either
+        auto* incoming = hasNext.load (std::memory_order_acquire) ? next : nullptr;
+
+        if (incoming != nullptr && incoming->partitionSize != partitionSize)
+        {
+            takeOverNext();
+            partitionImpulse (*current, partitionSize, *fft, scratch);
+            incoming = nullptr;
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* history = getInputHistory (ch);
+            auto* lineReal = delayLineReal.data() + spectrumSize * (size_t) ch;
+            auto* lineImag = delayLineImag.data() + spectrumSize * (size_t) ch;
+
+            // Transform the newest 2P samples into the delay line slot
+            std::fill (scratch.begin(), scratch.end(), 0.0f);
+            std::copy (history, history + 2 * partitionSize, scratch.data());
+            fft->performRealOnlyForwardTransform (scratch.data(), true);
+            deinterleave (scratch, numBins, lineReal + delayLinePosition * numBins, lineImag + delayLinePosition * numBins);
+
+            auto* output = getOutputFifo (ch);
+            convolve (lineReal, lineImag, *current, output);
+
+            if (incoming != nullptr)
+            {
+                convolve (lineReal, lineImag, *incoming, crossfade.data());
+
+                for (int i = 0; i < partitionSize; ++i)
+                    output[i] += (crossfade[(size_t) i] - output[i]) * (float) (i + 1) / (float) partitionSize;
+            }
+
+            // The new half becomes the old half of the next partition
+            std::copy (history + partitionSize, history + 2 * partitionSize, history);
+        }
+
+        delayLinePosition = (delayLinePosition + 1) % numPartitions;
+
+        if (incoming != nullptr)
+            takeOverNext();
+    }
+
+    /** Writes one partition of output: the sum over partitions of X[t - p] * H[p], back in the time domain. */
+    void convolve (const float* lineReal, const float* lineImag, const Response& response, float* output) noexcept
+    {
+        auto numPartitions = getNumPartitions();
+
+        std::fill (accumulatorReal.begin(), accumulatorReal.begin() + numBins, 0.0f);
+        std::fill (accumulatorImag.begin(), accumulatorImag.begin() + numBins, 0.0f);
+
+        for (int p = 0; p < numPartitions; ++p)
+        {
+            auto slot = delayLinePosition - p;
+            slot += slot < 0 ? numPartitions : 0;
+
+            auto* xr = lineReal + slot * numBins;
+            auto* xi = lineImag + slot * numBins;
+            auto* hr = response.real.data() + p * numBins;
+            auto* hi = response.imag.data() + p * numBins;
+            auto* yr = accumulatorReal.data();
+            auto* yi = accumulatorImag.data();
+
+            for (int k = 0; k < numBins; ++k)
+            {
+                yr[k] += xr[k] * hr[k] - xi[k] * hi[k];
+                yi[k] += xr[k] * hi[k] + xi[k] * hr[k];
+            }
+        }
+
+        // Back to the time domain; with overlap-save only the second half is valid
+        auto fftSize = 2 * partitionSize;
+
+        for (int k = 0; k < numBins; ++k)
+        {
+            scratch[(size_t) (2 * k)] = accumulatorReal[(size_t) k];
+            scratch[(size_t) (2 * k + 1)] = accumulatorImag[(size_t) k];
+        }
+
+        for (int k = numBins; k < fftSize; ++k)
+        {
+            scratch[(size_t) (2 * k)] = accumulatorReal[(size_t) (fftSize - k)];
+            scratch[(size_t) (2 * k + 1)] = -accumulatorImag[(size_t) (fftSize - k)];
+        }
+
+        fft->performRealOnlyInverseTransform (scratch.data());
+        std::copy (scratch.data() + partitionSize, scratch.data() + fftSize, output);
+    }
+
+    static void deinterleave (const std::vector<float>& interleaved, int bins, float* real, float* imag) noexcept
+    {
+        for (int k = 0; k < bins; ++k)
+        {
+            real[k] = interleaved[(size_t) (2 * k)];
+            imag[k] = interleaved[(size_t) (2 * k + 1)];
+        }
+    }
+
+    //==============================================================================
+    std::vector<std::unique_ptr<juce::dsp::FFT>> ffts, nextFfts;
+    juce::dsp::FFT* fft = nullptr;
+
+    // The response in use and the one being prepared or waiting to take over. Whoever
+    // hasNext says owns next: the preparing thread while it's false, process() after
+    std::array<Response, 2> responses;
+    Response* current = &responses[0];
+    Response* next = &responses[1];
+    std::atomic<bool> hasNext { false };
+    std::atomic<int> latestPartitionSize { 0 };
+
+    std::vector<float> delayLineReal, delayLineImag, accumulatorReal, accumulatorImag;
+    std::vector<float> inputHistory, outputFifo, crossfade, scratch, nextScratch;
+
+    int numChannels = 0, maximumImpulseLength = 0;
+    int partitionSize = 0, numBins = 0, fifoPosition = 0, delayLinePosition = 0;
+
+    JUCE_LEAK_DETECTOR (PartitionedConvolution)
+};
@@ -11,30 +11,175 @@
 
 //==============================================================================
 BassicManagerAudioProcessorEditor::BassicManagerAudioProcessorEditor (BassicManagerAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), meterSource (p.getMeterSource()), profiler (p.getProfiler()),
+      lfeScratch ((size_t) SpectrumAnalyserComponent::fftSize),
+      mainsScratch ((size_t) SpectrumAnalyserComponent::fftSize)
 {
+    auto& state = audioProcessor.getValueTreeState();
+
+    addSlider (crossoverSlider, crossoverLabel, "crossoverFrequency", crossoverAttachment);
+    addSlider (lfeLowPassSlider, lfeLowPassLabel, "lfeLowPassFrequency", lfeLowPassAttachment);
+    addComboBox (topologyBox, topologyLabel, "crossoverTopology", topologyAttachment);
+    addComboBox (partitionBox, partitionLabel, "linearPhasePartition", partitionAttachment);
+    addComboBox (slopeBox, slopeLabel, "crossoverSlope", slopeAttachment);
+
+    addAndMakeVisible (lfeBoostButton);
+    addAndMakeVisible (multiRateButton);
+    addAndMakeVisible (limiterButton);
+    lfeBoostAttachment = std::make_unique<ButtonAttachment> (state, "lfeBoost", lfeBoostButton);
+    multiRateAttachment = std::make_unique<ButtonAttachment> (state, "multiRate", multiRateButton);
+    limiterAttachment = std::make_unique<ButtonAttachment> (state, "lfeLimiter", limiterButton);
+
+    // The ceiling sits under the slope box, so it's a bar like the boxes rather than a knob
+    addSlider (limiterCeilingSlider, limiterCeilingLabel, "lfeLimiterCeiling", limiterCeilingAttachment);
+    limiterCeilingSlider.setSliderStyle (juce::Slider::LinearHorizontal);
+    limiterCeilingSlider.setTextBoxStyle (juce::Slider::TextBoxRight, false, 70, 18);
+    limiterCeilingSlider.setTextValueSuffix (" dB");
+    limiterCeilingLabel.setJustificationType (juce::Justification::centredLeft);
+
+    addAndMakeVisible (levelMeters);
+    addAndMakeVisible (spectrumAnalyser);
+    addAndMakeVisible (processingLoad);
+    updateChannelNames();
+
+    // From here on the audio thread starts publishing levels and samples
+    meterSource.setActive (true);
+    profiler.setStageTimingEnabled (true);
+    startTimerHz (frameRate);
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setSize (760, 620);
 }
 
 BassicManagerAudioProcessorEditor::~BassicManagerAudioProcessorEditor()
 {
+    stopTimer();
+    meterSource.setActive (false);
+    profiler.setStageTimingEnabled (false);
+}
+
+void BassicManagerAudioProcessorEditor::addSlider (juce::Slider& slider, juce::Label& label, const juce::String& parameterID,
+                                                   std::unique_ptr<SliderAttachment>& attachment)
+{
+    auto& state = audioProcessor.getValueTreeState();
+
+    slider.setSliderStyle (juce::Slider::RotaryHorizontalVerticalDrag);
+    slider.setTextBoxStyle (juce::Slider::TextBoxBelow, false, 80, 18);
+    slider.setTextValueSuffix (" Hz");
+    addAndMakeVisible (slider);
+
+    label.setText (state.getParameter (parameterID)->getName (32), juce::dontSendNotification);
+    label.setJustificationType (juce::Justification::centred);
+    label.attachToComponent (&slider, false);
+
+    attachment = std::make_unique<SliderAttachment> (state, parameterID, slider);
+}
+
+void BassicManagerAudioProcessorEditor::addComboBox (juce::ComboBox& box, juce::Label& label, const juce::String& parameterID,
+                                                     std::unique_ptr<ComboBoxAttachment>& attachment)
+{
+    auto& state = audioProcessor.getValueTreeState();
+
+    // The attachment selects by item index, so the items have to be there first
+    if (auto* choice = dynamic_cast<juce::AudioParameterChoice*> (state.getParameter (parameterID)))
+        box.addItemList (choice->choices, 1);
+
+    addAndMakeVisible (box);
+
+    label.setText (state.getParameter (parameterID)->getName (32), juce::dontSendNotification);
+    label.attachToComponent (&box, false);
+
+    attachment = std::make_unique<ComboBoxAttachment> (state, parameterID, box);
+}
+
+void BassicManagerAudioProcessorEditor::updateChannelNames()
+{
+    auto layout = audioProcessor.getChannelLayoutOfBus (false, 0);
+
+    if (layout.size() == meteredChannels)
+        return;
+
+    meteredChannels = layout.size();
+
+    juce::StringArray names;
+
+    for (int ch = 0; ch < layout.size(); ++ch)
+        names.add (juce::AudioChannelSet::getAbbreviatedChannelTypeName (layout.getTypeOfChannel (ch)));
+
+    levelMeters.setChannelNames (names);
 }
 
 //==============================================================================
+void BassicManagerAudioProcessorEditor::timerCallback()
+{
+    updateChannelNames();
+    spectrumAnalyser.setSampleRate (meterSource.getSampleRate());
+
+    MeterSource::Summary summary;
+    auto hasNewData = meterSource.readSummaries (summary) > 0;
+    levelMeters.update (summary, hasNewData, 1.0 / frameRate);
+
+    // Drain everything, the analyser keeps only the newest window
+    for (;;)
+    {
+        auto numRead = meterSource.readSpectrumSamples (lfeScratch.data(), mainsScratch.data(), (int) lfeScratch.size());
+
+        if (numRead == 0)
+            break;
+
+        spectrumAnalyser.pushSamples (lfeScratch.data(), mainsScratch.data(), numRead);
+    }
+
+    if (spectrumAnalyser.processIfReady())
+        spectrumAnalyser.repaint();
+
+    // Numbers that change 30 times a second can't be read
+    if (--framesUntilLoadUpdate <= 0)
+    {
+        processingLoad.update (profiler.getSnapshot(), audioProcessor.getSilenceSkipRate());
+        framesUntilLoadUpdate = framesPerLoadUpdate;
+    }
+}
+
 void BassicManagerAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void BassicManagerAudioProcessorEditor::resized()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    auto area = getLocalBounds().reduced (10);
+
+    auto controls = area.removeFromTop (130);
+    controls.removeFromTop (20);    // room for the attached labels
+
+    crossoverSlider.setBounds (controls.removeFromLeft (120));
+    lfeLowPassSlider.setBounds (controls.removeFromLeft (120));
+    controls.removeFromLeft (20);
+
+    auto toggles = controls.removeFromLeft (130);
+    lfeBoostButton.setBounds (toggles.removeFromTop (30));
+    multiRateButton.setBounds (toggles.removeFromTop (30));
+    limiterButton.setBounds (toggles.removeFromTop (30));
+    controls.removeFromLeft (10);
+
+    auto slopeColumn = controls.removeFromRight (controls.getWidth() / 2);
+    slopeColumn.removeFromLeft (10);
+    slopeBox.setBounds (slopeColumn.removeFromTop (24));
+    slopeColumn.removeFromTop (26);
+    limiterCeilingSlider.setBounds (slopeColumn.removeFromTop (24));
+
+    topologyBox.setBounds (controls.removeFromTop (24));
+    controls.removeFromTop (26);
+    partitionBox.setBounds (controls.removeFromTop (24));
+
+    area.removeFromTop (10);
+    processingLoad.setBounds (area.removeFromBottom (7 * 16));
+    area.removeFromBottom (10);
+
+    levelMeters.setBounds (area.removeFromLeft (juce::jmax (200, 24 * (meteredChannels + 1))));
+    area.removeFromLeft (10);
+    spectrumAnalyser.setBounds (area);
 }
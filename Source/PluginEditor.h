@@ -9,11 +9,20 @@
 #pragma once
 
 #include "PluginProcessor.h"
+#include "MeteringComponents.h"
 
 //==============================================================================
 /**
+    Parameter controls above per-channel meters, an LFE/mains spectrum and a
+    breakdown of processing time.
+
+    The processor only pushes summaries and samples into its MeterSource while
+    this editor exists, and only times its stages individually then. A timer
+    on the message thread drains them at frameRate, runs the analyser and
+    repaints; nothing here ever blocks the audio thread.
 */
-class BassicManagerAudioProcessorEditor  : public juce::AudioProcessorEditor
+class BassicManagerAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                           private juce::Timer
 {
 public:
     BassicManagerAudioProcessorEditor (BassicManagerAudioProcessor&);
@@ -24,9 +33,41 @@ public:
     void resized() override;
 
 private:
+    static constexpr int frameRate = 30;
+    static constexpr int framesPerLoadUpdate = 10;
+
+    void timerCallback() override;
+    void updateChannelNames();
+
+    using SliderAttachment = juce::AudioProcessorValueTreeState::SliderAttachment;
+    using ButtonAttachment = juce::AudioProcessorValueTreeState::ButtonAttachment;
+    using ComboBoxAttachment = juce::AudioProcessorValueTreeState::ComboBoxAttachment;
+
+    void addSlider (juce::Slider&, juce::Label&, const juce::String& parameterID, std::unique_ptr<SliderAttachment>&);
+    void addComboBox (juce::ComboBox&, juce::Label&, const juce::String& parameterID, std::unique_ptr<ComboBoxAttachment>&);
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     BassicManagerAudioProcessor& audioProcessor;
+    MeterSource& meterSource;
+    ProcessingProfiler& profiler;
+
+    juce::Slider crossoverSlider, lfeLowPassSlider, limiterCeilingSlider;
+    juce::Label crossoverLabel, lfeLowPassLabel, limiterCeilingLabel, topologyLabel, partitionLabel, slopeLabel;
+    juce::ToggleButton lfeBoostButton { "LFE Boost" }, multiRateButton { "Multi-rate" }, limiterButton { "LFE Limiter" };
+    juce::ComboBox topologyBox, partitionBox, slopeBox;
+
+    std::unique_ptr<SliderAttachment> crossoverAttachment, lfeLowPassAttachment, limiterCeilingAttachment;
+    std::unique_ptr<ButtonAttachment> lfeBoostAttachment, multiRateAttachment, limiterAttachment;
+    std::unique_ptr<ComboBoxAttachment> topologyAttachment, partitionAttachment, slopeAttachment;
+
+    LevelMeterComponent levelMeters;
+    SpectrumAnalyserComponent spectrumAnalyser;
+    ProcessingLoadComponent processingLoad;
+
+    // Message-thread scratch for draining the analyser FIFO
+    std::vector<float> lfeScratch, mainsScratch;
+    int meteredChannels = -1, framesUntilLoadUpdate = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BassicManagerAudioProcessorEditor)
 };
@@ -18,41 +18,126 @@ BassicManagerAudioProcessor::BassicManagerAudioProcessor()
                        .withInput  ("Input",  juce::AudioChannelSet::create5point1(), true)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::create5point1(), true)
+                       .withOutput ("Subwoofers", juce::AudioChannelSet::discreteChannels (2), false)
                      #endif
                        ),
-        sumBuffer(5, getSampleRate()),
-        crossoverFrequency(60.0f),
-        lfeLowPassFrequency(120.0f),
-        lowPassBoost(10.0f),
-        parameters (*this, nullptr, juce::Identifier ("APVTSTutorial"),
-                      {
-                            std::make_unique<juce::AudioParameterFloat> ("crossoverFrequency",
-                                                         "Crossover Frequency",
-                                                         20.0f,
-                                                         250.0f,
-                                                         60.0f),
-                            std::make_unique<juce::AudioParameterFloat> ("lfeLowPassFrequency",
-                                                                       "LFE Low Pass Frequency",
-                                                                       20.0f,
-                                                                       250.0f,
-                                                                       120.0f),
-                            std::make_unique<juce::AudioParameterBool> ("lfeBoost",
-                                                                      "LFE Boost",
-                                                                      false)
-                      })
+        parameters (*this, nullptr, juce::Identifier ("BassicManager"), createParameterLayout())
 #endif
 {
-    // Setup satellite speaker filters
-    for(int i=0; i<5; i++)
+    // Creation order is the binary state's order
+    for (auto* parameter : getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+            stateParameters.push_back(ranged);
+    
+    startTimerHz(pollingHz);
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout BassicManagerAudioProcessor::createParameterLayout()
+{
+    // Parameters that change the latency can't be automated, since hosts only pick up
+    // a new latency when they restart playback
+    auto latencyChangingBool = juce::AudioParameterBoolAttributes().withAutomatable(false);
+    auto latencyChangingChoice = juce::AudioParameterChoiceAttributes().withAutomatable(false);
+    
+    juce::AudioProcessorValueTreeState::ParameterLayout layout {
+        std::make_unique<juce::AudioParameterFloat> ("crossoverFrequency",
+                                                   "Crossover Frequency",
+                                                   20.0f,
+                                                   250.0f,
+                                                   60.0f),
+        std::make_unique<juce::AudioParameterFloat> ("lfeLowPassFrequency",
+                                                   "LFE Low Pass Frequency",
+                                                   20.0f,
+                                                   250.0f,
+                                                   120.0f),
+        std::make_unique<juce::AudioParameterBool> ("lfeBoost",
+                                                  "LFE Boost",
+                                                  false),
+        std::make_unique<juce::AudioParameterBool> ("multiRate",
+                                                  "Multi-rate Bass Path",
+                                                  false,
+                                                  latencyChangingBool),
+        std::make_unique<juce::AudioParameterChoice> ("crossoverTopology",
+                                                    "Crossover Topology",
+                                                    juce::StringArray { "Biquad", "State Variable", "Linear Phase" },
+                                                    0,
+                                                    latencyChangingChoice),
+        std::make_unique<juce::AudioParameterChoice> ("linearPhasePartition",
+                                                    "Linear Phase Partition",
+                                                    juce::StringArray { "64", "128", "256", "512", "1024" },
+                                                    2,
+                                                    latencyChangingChoice),
+        std::make_unique<juce::AudioParameterChoice> ("crossoverSlope",
+                                                    "Crossover Slope",
+                                                    juce::StringArray { "Classic", "LR2", "LR4", "LR8",
+                                                                        "Butterworth 2", "Butterworth 3", "Butterworth 4", "Butterworth 5",
+                                                                        "Butterworth 6", "Butterworth 7", "Butterworth 8" },
+                                                    0)
+    };
+    
+    // A distance delay and a trim for every channel of the largest layout, in channel order
+    for (int ch = 1; ch <= BassManagementChannelMap::maxChannels; ++ch)
+    {
+        layout.add(std::make_unique<juce::AudioParameterFloat> ("channelDelay" + juce::String(ch),
+                                                               "Channel " + juce::String(ch) + " Delay",
+                                                               0.0f,
+                                                               (float) (SpeakerAlignment<float>::maximumDelaySeconds * 1000.0),
+                                                               0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat> ("channelTrim" + juce::String(ch),
+                                                               "Channel " + juce::String(ch) + " Trim",
+                                                               -24.0f,
+                                                               12.0f,
+                                                               0.0f));
+    }
+    
+    // Gain, polarity, delay and low-pass of each feed on the optional subwoofer bus
+    for (int sub = 1; sub <= BassManagementChannelMap::maxSubwoofers; ++sub)
     {
-        filterArrays.add(new juce::OwnedArray<IIR::Filter<float>>);
-        for(int j=0; j<8; j++)
-            filterArrays[i]->add(new IIR::Filter<float>());
+        layout.add(std::make_unique<juce::AudioParameterFloat> ("subwooferGain" + juce::String(sub),
+                                                               "Sub " + juce::String(sub) + " Gain",
+                                                               -24.0f,
+                                                               12.0f,
+                                                               0.0f));
+        layout.add(std::make_unique<juce::AudioParameterBool> ("subwooferInvert" + juce::String(sub),
+                                                              "Sub " + juce::String(sub) + " Invert",
+                                                              false));
+        layout.add(std::make_unique<juce::AudioParameterFloat> ("subwooferDelay" + juce::String(sub),
+                                                               "Sub " + juce::String(sub) + " Delay",
+                                                               0.0f,
+                                                               (float) (SpeakerAlignment<float>::maximumDelaySeconds * 1000.0),
+                                                               0.0f));
+        layout.add(std::make_unique<juce::AudioParameterFloat> ("subwooferLowPass" + juce::String(sub),
+                                                               "Sub " + juce::String(sub) + " Low Pass",
+                                                               20.0f,
+                                                               250.0f,
+                                                               250.0f));
     }
+    
+    // True-peak protection for the LFE and subwoofer outputs
+    layout.add(std::make_unique<juce::AudioParameterBool> ("lfeLimiter",
+                                                          "LFE Limiter",
+                                                          false,
+                                                          latencyChangingBool));
+    layout.add(std::make_unique<juce::AudioParameterFloat> ("lfeLimiterCeiling",
+                                                           "LFE Limiter Ceiling",
+                                                           -12.0f,
+                                                           0.0f,
+                                                           -1.0f));
+    
+    // Spreads very wide layouts' mains over worker threads. The workers are started in
+    // prepareToPlay, so switching this on takes effect the next time the host prepares,
+    // and it isn't offered for automation
+    layout.add(std::make_unique<juce::AudioParameterBool> ("parallelChannels",
+                                                          "Parallel Channels",
+                                                          false,
+                                                          juce::AudioParameterBoolAttributes().withAutomatable(false)));
+    
+    return layout;
 }
 
 BassicManagerAudioProcessor::~BassicManagerAudioProcessor()
-{        
+{
+    stopTimer();
 }
 
 //==============================================================================
@@ -122,29 +207,28 @@ void BassicManagerAudioProcessor::prepareToPlay (double sampleRate, int samplesP
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-    ProcessSpec highPassSpec { sampleRate, static_cast<juce::uint32> (samplesPerBlock), 1 };
-    ProcessSpec lowPassSpec { sampleRate, static_cast<juce::uint32> (samplesPerBlock), 1 };
-                                                        
-    for(int i=0; i<5; i++){
-        auto filterArray = filterArrays.getUnchecked(i);
-        for(int j=0; j<8; j++)
-        {
-            auto filter = filterArray->getUnchecked(j);
-            filter->prepare(highPassSpec);
-        }
-    }
+    meterSource.prepare(getTotalNumOutputChannels(), sampleRate);
+    profiler.prepare(sampleRate);
     
-    sumLowPassFilter.prepare(lowPassSpec);
-        
-    lfeLowPassFilter.prepare(lowPassSpec);
+    // Hosts set the precision before preparing, so only one engine needs its buffers
+    auto layout = getChannelLayoutOfBus(true, 0);
+    auto* subwooferBus = getBus(false, 1);
+    auto numSubwoofers = subwooferBus != nullptr ? subwooferBus->getNumberOfChannels() : 0;
+    auto& engineParameters = parameterSnapshot.update();
     
-    sumBuffer.setSize(1, samplesPerBlock);
-    
-    crossoverFrequency.reset(sampleRate, 0.001);
-    lfeLowPassFrequency.reset(sampleRate, 0.001);
+    if (isUsingDoublePrecision())
+    {
+        doubleEngine.prepare(sampleRate, layout, numSubwoofers, engineParameters);
+        engineLatency = doubleEngine.getLatencySamples();
+    }
+    else
+    {
+        floatEngine.prepare(sampleRate, layout, numSubwoofers, engineParameters);
+        engineLatency = floatEngine.getLatencySamples();
+    }
     
-    updateCrossoverFrequency(sampleRate);
-    lfeLowPassFilter.setCutoffFrequency(lfeLowPassFrequency.getNextValue());
+    // Hosts call this off the audio thread and expect the latency to be current when it returns
+    setLatencySamples(engineLatency);
 }
 
 void BassicManagerAudioProcessor::releaseResources()
@@ -160,11 +244,8 @@ bool BassicManagerAudioProcessor::isBusesLayoutSupported (const BusesLayout& lay
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainInputChannels() <= 6)
+    // Only the surround layouts that have a channel map
+    if (! BassManagementChannelMap::isSupported(layouts.getMainInputChannelSet()))
         return false;
 
     // This checks if the input layout matches the output layout
@@ -173,30 +254,55 @@ bool BassicManagerAudioProcessor::isBusesLayoutSupported (const BusesLayout& lay
         return false;
    #endif
 
+    // The subwoofer feeds are an optional second output bus
+    if (layouts.outputBuses.size() > 1 && ! BassManagementChannelMap::isSupportedSubwooferLayout(layouts.getChannelSet(false, 1)))
+        return false;
+
     return true;
   #endif
 }
 #endif
 
-void BassicManagerAudioProcessor::updateCrossoverFrequency(double sampleRate)
+juce::AudioProcessor::BusesLayout BassicManagerAudioProcessor::makeBusesLayout(const juce::AudioChannelSet& mains, int numSubwoofers)
 {
-    auto coefficientsArray = FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(crossoverFrequency.getNextValue(), sampleRate, 1);
-            
-    for(int i=0; i<5; i++){
-        auto filterArray = filterArrays.getUnchecked(i);
-        for(int j=0; j<8; j++)
-        {
-            auto filter = filterArray->getUnchecked(j);
-            filter->coefficients = *coefficientsArray[0];
-        }
-    }
+    BusesLayout buses;
+    buses.inputBuses.add(mains);
+    buses.outputBuses.add(mains);
+    buses.outputBuses.add(numSubwoofers > 0 ? juce::AudioChannelSet::discreteChannels(numSubwoofers)
+                                            : juce::AudioChannelSet::disabled());
+    return buses;
+}
+
+double BassicManagerAudioProcessor::getSilenceSkipRate() const noexcept
+{
+    auto skipped = static_cast<double> (floatEngine.getNumSkippedTiles() + doubleEngine.getNumSkippedTiles());
+    auto total = skipped + static_cast<double> (floatEngine.getNumProcessedTiles() + doubleEngine.getNumProcessedTiles());
     
-    sumLowPassFilter.setCutoffFrequency(crossoverFrequency.getNextValue());
+    return total > 0.0 ? skipped / total : 0.0;
+}
+
+int BassicManagerAudioProcessor::getNumChannelGroupWorkers() const noexcept
+{
+    return isUsingDoublePrecision() ? doubleEngine.getNumWorkers() : floatEngine.getNumWorkers();
 }
 
 void BassicManagerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBlockWith(floatEngine, buffer);
+}
+
+void BassicManagerAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    jassert (isUsingDoublePrecision());
+    processBlockWith(doubleEngine, buffer);
+}
+
+template <typename SampleType>
+void BassicManagerAudioProcessor::processBlockWith(BassManagementEngine<SampleType>& engine, juce::AudioBuffer<SampleType>& buffer)
 {
     juce::ScopedNoDenormals noDenormals;
+    RealtimeAudit::ScopedAudioCallback auditedCallback;
+    ProcessingProfiler::ScopedBlock profiledBlock(profiler, buffer.getNumSamples());
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -209,62 +315,29 @@ void BassicManagerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
     
-    // Sum the full range channels to a new buffer and lowPass
-    
-    sumBuffer.copyFrom(0, 0, buffer, CHANNELS::L, 0, buffer.getNumSamples());
-    sumBuffer.addFrom(0, 0, buffer, CHANNELS::R, 0, buffer.getNumSamples());
-    sumBuffer.addFrom(0, 0, buffer, CHANNELS::C, 0, buffer.getNumSamples());
-    sumBuffer.addFrom(0, 0, buffer, CHANNELS::LS, 0, buffer.getNumSamples());
-    sumBuffer.addFrom(0, 0, buffer, CHANNELS::RS, 0, buffer.getNumSamples());
-    
-    AudioBlock<float> sumBufferBlock(sumBuffer);
-    ProcessContextReplacing<float> sumBufferContext(sumBufferBlock);
-    sumLowPassFilter.process(sumBufferContext);
-    
-    // Replace the full range output high-passed
-    
-    AudioBlock<float> block(buffer);
-    
-    int filterCounter = 0;
-        
-    for(int i : {L, R, C, LS, RS}){
-        
-        auto channelBlock = block.getSingleChannelBlock(i);
-        
-        ProcessContextReplacing<float> context(channelBlock);
-        auto filterArray = filterArrays.getUnchecked(filterCounter);
-        for(int j=0; j<8; j++)
-        {
-            auto filter = filterArray->getUnchecked(j);
-            filter->process(context);
-        }
-        
-        filterCounter++;
-    }
-    
-    // Replace the LFE channel with its low-passed version
-    // apply +10dB of gain
-    // then add the summed low pass content
-    
-    auto channelBlock = block.getSingleChannelBlock(CHANNELS::LFE);
-    ProcessContextReplacing<float> lfeLowPassContext(channelBlock);
-    lfeLowPassFilter.process(lfeLowPassContext);
-    
-    buffer.applyGain(CHANNELS::LFE, 0, buffer.getNumSamples(), juce::Decibels::decibelsToGain(10));
-    
-    buffer.addFrom(CHANNELS::LFE, 0, sumBuffer, 0, 0, buffer.getNumSamples());
-        
-    lfeLowPassFrequency.setTargetValue(*parameters.getRawParameterValue("lfeLowPassFrequency"));
-    lfeLowPassFrequency.getNextValue();
+    // Only what changed since the last block gets recomputed
+    engine.process(buffer, parameterSnapshot.update());
     
-    if(lfeLowPassFrequency.isSmoothing())
-        lfeLowPassFilter.setCutoffFrequency(lfeLowPassFrequency.getNextValue());
+    // Mode switches can change the latency; the timer tells the host
+    engineLatency.store(engine.getLatencySamples(), std::memory_order_relaxed);
     
-    crossoverFrequency.setTargetValue(*parameters.getRawParameterValue("crossoverFrequency"));
-    crossoverFrequency.getNextValue();
+    // Offline there's no deadline to miss and the message thread may not be polling,
+    // so a retuned linear-phase crossover gets its FIRs designed right away
+    if (isNonRealtime())
+        engine.updateLinearPhaseResponses();
+}
+
+void BassicManagerAudioProcessor::timerCallback()
+{
+    // setLatencySamples only notifies the host when the value actually changed
+    setLatencySamples(engineLatency.load(std::memory_order_relaxed));
     
-    if(crossoverFrequency.isSmoothing())
-        updateCrossoverFrequency(getSampleRate());
+    // Designing a linear-phase FIR takes too long for the audio thread, which fades
+    // to it once it's ready
+    if (isUsingDoublePrecision())
+        doubleEngine.updateLinearPhaseResponses();
+    else
+        floatEngine.updateLinearPhaseResponses();
 }
 
 //==============================================================================
@@ -275,30 +348,33 @@ bool BassicManagerAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* BassicManagerAudioProcessor::createEditor()
 {
-    return new juce::GenericAudioProcessorEditor(*this);
-//    return new BassicManagerAudioProcessorEditor (*this);
+    return new BassicManagerAudioProcessorEditor (*this);
 }
 
 //==============================================================================
 void BassicManagerAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    auto state = parameters.copyState();
-           std::unique_ptr<juce::XmlElement> xml (state.createXml());
-           copyXmlToBinary (*xml, destData);
+    // Raw parameter values rather than XML, so sessions with many instances recall quickly
+    BinaryParameterState::write(stateParameters, destData);
 }
 
 void BassicManagerAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    if (BinaryParameterState::isBinaryState(data, sizeInBytes))
+    {
+        BinaryParameterState::read(data, sizeInBytes, stateParameters);
+        return;
+    }
+    
+    // Sessions saved before the binary format hold XML, under the tree's old name or its current one
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
-     
-            if (xmlState.get() != nullptr)
-                if (xmlState->hasTagName (parameters.state.getType()))
-                    parameters.replaceState (juce::ValueTree::fromXml (*xmlState));
+    
+    if (xmlState != nullptr && (xmlState->hasTagName (parameters.state.getType()) || xmlState->hasTagName ("APVTSTutorial")))
+    {
+        juce::ValueTree state (parameters.state.getType());
+        state.copyPropertiesAndChildrenFrom (juce::ValueTree::fromXml (*xmlState), nullptr);
+        parameters.replaceState (state);
+    }
 }
 
 //==============================================================================
@@ -11,12 +11,20 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 
+#include "BassManagementEngine.h"
+#include "MeterSource.h"
+#include "ParameterSnapshot.h"
+#include "ParameterState.h"
+#include "ProcessingProfiler.h"
+#include "RealtimeAudit.h"
+
 using namespace juce::dsp;
 
 //==============================================================================
 /**
 */
-class BassicManagerAudioProcessor  : public juce::AudioProcessor
+class BassicManagerAudioProcessor  : public juce::AudioProcessor,
+                                     private juce::Timer
 {
 public:
     //==============================================================================
@@ -32,6 +40,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    // Both precisions run the same templated engine, so 64-bit hosts need no conversion
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -56,22 +68,56 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
-    void updateCrossoverFrequency(double sampleRate);
-    
+    // Channel order of the default 5.1 layout; other layouts are handled through BassManagementChannelMap
     enum CHANNELS { L, R, C, LFE, LS, RS};
+    
+    juce::AudioProcessorValueTreeState& getValueTreeState() noexcept { return parameters; }
+    MeterSource& getMeterSource() noexcept { return meterSource; }
+    ProcessingProfiler& getProfiler() noexcept { return profiler; }
+    
+    // The same surround layout in and out, plus a subwoofer bus with numSubwoofers feeds (0 switches it off)
+    static BusesLayout makeBusesLayout(const juce::AudioChannelSet& mains, int numSubwoofers = 0);
+    
+    // Fraction of channel tiles (mains and bass path) skipped as silent since prepareToPlay
+    double getSilenceSkipRate() const noexcept;
+    
+    // Worker threads running channel groups alongside the audio thread, 0 when it runs them all
+    int getNumChannelGroupWorkers() const noexcept;
 
 private:
     //==============================================================================
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+    
+    template <typename SampleType>
+    void processBlockWith(BassManagementEngine<SampleType>& engine, juce::AudioBuffer<SampleType>& buffer);
+    
+    // Passes latency changes from the audio thread on to the host
+    void timerCallback() override;
+    
     juce::AudioProcessorValueTreeState parameters;
     
-    juce::AudioBuffer<float> sumBuffer;
-    juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> crossoverFrequency, lfeLowPassFrequency;
-    float lowPassBoost;
+    // Looked up once, since building the ID strings in processBlock would allocate
+    ParameterSnapshot parameterSnapshot { parameters };
+    
+    // Every parameter in creation order, for the binary state
+    std::vector<juce::RangedAudioParameter*> stateParameters;
+    
+    // Levels and analyser input for the editor, only gathered while it is open
+    MeterSource meterSource;
+    
+    // Block deadlines are always checked; per-stage timing is switched on by the editor or a trace
+    ProcessingProfiler profiler;
+    
+    // Only the engine for the host's processing precision is prepared
+    BassManagementEngine<float> floatEngine { profiler, meterSource };
+    BassManagementEngine<double> doubleEngine { profiler, meterSource };
     
-    juce::OwnedArray<juce::OwnedArray<IIR::Filter<float>>> filterArrays;
-    LinkwitzRileyFilter<float> sumLowPassFilter, lfeLowPassFilter;
-        
+    // The engine's latency as of the last block. Telling the host takes the processor's
+    // listener lock, so that happens on the message thread
+    std::atomic<int> engineLatency { 0 };
     
+    // How often the message thread passes the latency on and designs retuned linear-phase FIRs
+    static constexpr int pollingHz = 20;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BassicManagerAudioProcessor)
 };
@@ -0,0 +1,367 @@
+/*
+  ==============================================================================
+
+    Per-stage timing of processBlock, with histograms and trace export.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <array>
+#include <atomic>
+#include <cmath>
+
+//==============================================================================
+/**
+    Measures where processBlock spends its time.
+
+    Every block is timed against its real-time deadline (numSamples / sampleRate)
+    and the result lands in a histogram, which costs two clock reads per block
+    and is always on. With setStageTimingEnabled (true), the stages inside the
+    block are timed too: each ScopedStage adds its span to the block's running
+    total for that stage, and at the end of the block those totals go into
+    per-stage histograms. When a block misses its deadline, the stage that took
+    longest is blamed, which tells coefficient redesign spikes apart from
+    steady-state filtering.
+
+    All statistics are relaxed atomics written only by the audio thread, so the
+    editor can take a Snapshot at any time without locking. With
+    setTraceEnabled (true), every span is also queued in a wait-free FIFO for
+    readEvents(), and ChromeTraceWriter turns those into a trace that
+    chrome://tracing and Perfetto can open. The FIFO is only allocated the
+    first time tracing is switched on, since most instances never trace.
+*/
+class ProcessingProfiler
+{
+public:
+    enum Stage
+    {
+        bassSum,            // summing the mains and low-passing the sum (the whole bass path when multi-rate)
+        mainHighPass,       // the mains' high-pass, or the linear-phase split
+        lfeMix,             // the LFE low-pass and the mix of the bass into it
+        speakerAlignment,   // per-channel distance delays and trims
+        coefficientUpdate,  // mode switches, retuning and filter redesign
+        wholeBlock,
+        numStages
+    };
+
+    static const char* getStageName (int stage) noexcept
+    {
+        static constexpr const char* names[] = { "bassSum", "mainHighPass", "lfeMix", "speakerAlignment", "coefficientUpdate", "processBlock" };
+        return names[stage];
+    }
+
+    /** Histogram bins are spaced a quarter octave apart, from 64 ns up to about 67 ms. */
+    static constexpr int numHistogramBins = 80;
+    static constexpr int binsPerOctave = 4;
+    static constexpr double lowestBinNanoseconds = 64.0;
+
+    static double getBinUpperEdgeNanoseconds (int bin) noexcept
+    {
+        return lowestBinNanoseconds * std::exp2 ((bin + 1) / (double) binsPerOctave);
+    }
+
+    static int getBinForNanoseconds (double nanoseconds) noexcept
+    {
+        if (nanoseconds <= lowestBinNanoseconds)
+            return 0;
+
+        return juce::jmin (numHistogramBins - 1, (int) (binsPerOctave * std::log2 (nanoseconds / lowestBinNanoseconds)));
+    }
+
+    /** One timed span, in Time::getHighResolutionTicks() units. */
+    struct Event
+    {
+        int stage = 0;
+        juce::int64 startTicks = 0, endTicks = 0;
+    };
+
+    struct StageStatistics
+    {
+        std::array<juce::uint32, numHistogramBins> histogram {};
+        juce::uint32 count = 0;
+        double totalNanoseconds = 0.0, maximumNanoseconds = 0.0;
+
+        double getMeanNanoseconds() const noexcept    { return count > 0 ? totalNanoseconds / count : 0.0; }
+    };
+
+    struct Snapshot
+    {
+        std::array<StageStatistics, numStages> stages;
+        std::array<juce::uint32, numStages> overrunsByStage {};
+        juce::uint32 blocks = 0, overruns = 0;
+
+        /** The fraction of the real-time budget used, averaged over every block so far. */
+        double averageLoad = 0.0;
+    };
+
+    ProcessingProfiler()
+        : nanosecondsPerTick (1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond())
+    {
+    }
+
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+    }
+
+    void setStageTimingEnabled (bool shouldBeEnabled) noexcept    { stageTimingEnabled = shouldBeEnabled; }
+    bool isStageTimingEnabled() const noexcept                   { return stageTimingEnabled.load (std::memory_order_relaxed); }
+
+    /** Queues every span for readEvents(). This implies stage timing. Switching it on
+        allocates the FIFO the first time, so call this off the audio thread.
+    */
+    void setTraceEnabled (bool shouldBeEnabled)
+    {
+        // Kept once allocated: the audio thread may still be tracing the current block
+        if (shouldBeEnabled && events.empty())
+            events.resize ((size_t) eventFifoSize);
+
+        traceEnabled.store (shouldBeEnabled, std::memory_order_release);
+    }
+
+    //==============================================================================
+    /** Times a whole processBlock call for the lifetime of the object. */
+    struct ScopedBlock
+    {
+        ScopedBlock (ProcessingProfiler& p, int numSamples) noexcept  : profiler (p)    { profiler.beginBlock (numSamples); }
+        ~ScopedBlock() noexcept                                                          { profiler.endBlock(); }
+
+        ScopedBlock (const ScopedBlock&) = delete;
+        ScopedBlock& operator= (const ScopedBlock&) = delete;
+
+        ProcessingProfiler& profiler;
+    };
+
+    /** Adds the lifetime of the object to a stage of the current block. Free when stage timing is off. */
+    struct ScopedStage
+    {
+        ScopedStage (ProcessingProfiler& p, Stage s) noexcept
+            : profiler (p), stage (s), startTicks (p.timingStages ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~ScopedStage() noexcept
+        {
+            if (profiler.timingStages)
+                profiler.addSpan (stage, startTicks, juce::Time::getHighResolutionTicks());
+        }
+
+        ScopedStage (const ScopedStage&) = delete;
+        ScopedStage& operator= (const ScopedStage&) = delete;
+
+        ProcessingProfiler& profiler;
+        const Stage stage;
+        const juce::int64 startTicks;
+    };
+
+    //==============================================================================
+    /** Reader: a consistent-enough copy of the statistics, taken without locking. */
+    Snapshot getSnapshot() const noexcept
+    {
+        Snapshot snapshot;
+
+        for (size_t s = 0; s < (size_t) numStages; ++s)
+        {
+            auto& source = statistics[s];
+            auto& dest = snapshot.stages[s];
+
+            for (size_t bin = 0; bin < (size_t) numHistogramBins; ++bin)
+                dest.histogram[bin] = source.histogram[bin].load (std::memory_order_relaxed);
+
+            dest.count = source.count.load (std::memory_order_relaxed);
+            dest.totalNanoseconds = (double) source.totalNanoseconds.load (std::memory_order_relaxed);
+            dest.maximumNanoseconds = (double) source.maximumNanoseconds.load (std::memory_order_relaxed);
+            snapshot.overrunsByStage[s] = overrunsByStage[s].load (std::memory_order_relaxed);
+        }
+
+        snapshot.blocks = snapshot.stages[wholeBlock].count;
+        snapshot.overruns = overruns.load (std::memory_order_relaxed);
+
+        auto budget = (double) budgetNanoseconds.load (std::memory_order_relaxed);
+        snapshot.averageLoad = budget > 0.0 ? snapshot.stages[wholeBlock].totalNanoseconds / budget : 0.0;
+
+        return snapshot;
+    }
+
+    /** Reader: pops up to maxEvents queued spans. Returns how many were read. */
+    int readEvents (Event* dest, int maxEvents) noexcept
+    {
+        int start1, size1, start2, size2;
+        eventFifo.prepareToRead (juce::jmin (maxEvents, eventFifo.getNumReady()), start1, size1, start2, size2);
+
+        std::copy (events.begin() + start1, events.begin() + start1 + size1, dest);
+        std::copy (events.begin() + start2, events.begin() + start2 + size2, dest + size1);
+
+        eventFifo.finishedRead (size1 + size2);
+        return size1 + size2;
+    }
+
+private:
+    static constexpr int eventFifoSize = 1 << 16;
+
+    struct AtomicStatistics
+    {
+        std::array<std::atomic<juce::uint32>, numHistogramBins> histogram {};
+        std::atomic<juce::uint32> count { 0 };
+        std::atomic<juce::int64> totalNanoseconds { 0 }, maximumNanoseconds { 0 };
+    };
+
+    void beginBlock (int numSamples) noexcept
+    {
+        timingStages = stageTimingEnabled.load (std::memory_order_relaxed) || traceEnabled.load (std::memory_order_relaxed);
+        tracing = traceEnabled.load (std::memory_order_acquire);
+        blockSamples = numSamples;
+        stageTicks = {};
+        blockStartTicks = juce::Time::getHighResolutionTicks();
+    }
+
+    void endBlock() noexcept
+    {
+        auto endTicks = juce::Time::getHighResolutionTicks();
+        auto deadline = 1.0e9 * blockSamples / sampleRate;
+        auto total = nanosecondsPerTick * (double) (endTicks - blockStartTicks);
+
+        record (wholeBlock, total);
+        push (wholeBlock, blockStartTicks, endTicks);
+        budgetNanoseconds.fetch_add ((juce::int64) deadline, std::memory_order_relaxed);
+
+        if (timingStages)
+            for (int s = 0; s < wholeBlock; ++s)
+                record (s, nanosecondsPerTick * (double) stageTicks[(size_t) s]);
+
+        if (blockSamples > 0 && total > deadline)
+        {
+            overruns.fetch_add (1, std::memory_order_relaxed);
+
+            // Blame whichever stage took longest; without stage timing there's nothing to go on
+            if (timingStages)
+            {
+                auto worst = (size_t) std::distance (stageTicks.begin(), std::max_element (stageTicks.begin(), stageTicks.end()));
+                overrunsByStage[worst].fetch_add (1, std::memory_order_relaxed);
+            }
+            else
+            {
+                overrunsByStage[(size_t) wholeBlock].fetch_add (1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void addSpan (Stage stage, juce::int64 startTicks, juce::int64 endTicks) noexcept
+    {
+        stageTicks[(size_t) stage] += endTicks - startTicks;
+        push (stage, startTicks, endTicks);
+    }
+
+    void record (int stage, double nanoseconds) noexcept
+    {
+        auto& s = statistics[(size_t) stage];
+        auto rounded = (juce::int64) nanoseconds;
+
+        s.histogram[(size_t) getBinForNanoseconds (nanoseconds)].fetch_add (1, std::memory_order_relaxed);
+        s.count.fetch_add (1, std::memory_order_relaxed);
+        s.totalNanoseconds.fetch_add (rounded, std::memory_order_relaxed);
+
+        // Only the audio thread writes, so a plain compare is enough
+        if (rounded > s.maximumNanoseconds.load (std::memory_order_relaxed))
+            s.maximumNanoseconds.store (rounded, std::memory_order_relaxed);
+    }
+
+    void push (int stage, juce::int64 startTicks, juce::int64 endTicks) noexcept
+    {
+        if (! tracing)
+            return;
+
+        int start1, size1, start2, size2;
+        eventFifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            events[(size_t) start1] = { stage, startTicks, endTicks };
+
+        eventFifo.finishedWrite (size1);
+    }
+
+    //==============================================================================
+    const double nanosecondsPerTick;
+    double sampleRate = 44100.0;
+
+    std::atomic<bool> stageTimingEnabled { false }, traceEnabled { false };
+
+    // Audio thread only, latched at the start of each block
+    bool timingStages = false, tracing = false;
+    int blockSamples = 0;
+    juce::int64 blockStartTicks = 0;
+    std::array<juce::int64, (size_t) wholeBlock> stageTicks {};
+
+    std::array<AtomicStatistics, (size_t) numStages> statistics;
+    std::array<std::atomic<juce::uint32>, (size_t) numStages> overrunsByStage {};
+    std::atomic<juce::uint32> overruns { 0 };
+    std::atomic<juce::int64> budgetNanoseconds { 0 };
+
+    juce::AbstractFifo eventFifo { eventFifoSize };
+    std::vector<Event> events;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProcessingProfiler)
+};
+
+//==============================================================================
+/**
+    Writes ProcessingProfiler events as Chrome trace-event JSON, which
+    chrome://tracing and ui.perfetto.dev both load. Each profiled thread gets its
+    own track; the document is closed when the writer is destroyed.
+*/
+class ChromeTraceWriter
+{
+public:
+    explicit ChromeTraceWriter (juce::OutputStream& output)  : stream (output)
+    {
+        stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    }
+
+    ~ChromeTraceWriter()
+    {
+        stream << "\n]}\n";
+        stream.flush();
+    }
+
+    void addThreadName (int threadId, const juce::String& name)
+    {
+        startEvent();
+        stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadId
+               << ",\"args\":{\"name\":\"" << name << "\"}}";
+    }
+
+    void addEvents (const ProcessingProfiler::Event* events, int numEvents, int threadId)
+    {
+        for (int i = 0; i < numEvents; ++i)
+        {
+            auto& event = events[i];
+
+            startEvent();
+            stream << "{\"name\":\"" << ProcessingProfiler::getStageName (event.stage)
+                   << "\",\"cat\":\"processBlock\",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId
+                   << ",\"ts\":" << juce::String (toMicroseconds (event.startTicks), 3)
+                   << ",\"dur\":" << juce::String (toMicroseconds (event.endTicks - event.startTicks), 3) << "}";
+        }
+    }
+
+private:
+    static double toMicroseconds (juce::int64 ticks) noexcept
+    {
+        return 1.0e6 * juce::Time::highResolutionTicksToSeconds (ticks);
+    }
+
+    void startEvent()
+    {
+        stream << (isFirstEvent ? "\n" : ",\n");
+        isFirstEvent = false;
+    }
+
+    juce::OutputStream& stream;
+    bool isFirstEvent = true;
+
+    JUCE_DECLARE_NON_COPYABLE (ChromeTraceWriter)
+};
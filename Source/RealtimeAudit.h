@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    Counts heap and lock traffic on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+
+//==============================================================================
+/**
+    Real-time safety instrumentation.
+
+    processBlock marks itself with a ScopedAudioCallback, which only sets a
+    thread-local flag and costs nothing measurable. The counting happens in
+    RealtimeAuditHooks.cpp, which replaces the global operator new and delete
+    and, on Linux, interposes pthread_mutex_lock. Those hooks call the note
+    functions below, which only count while the calling thread is inside a
+    callback.
+
+    The hooks are always linked into the Tests target. Configure with
+    BASSICMANAGER_REALTIME_AUDIT=ON to link them into the plugin as well.
+    Without the hooks, the counts simply stay at zero.
+*/
+namespace RealtimeAudit
+{
+    struct Counts
+    {
+        int allocations = 0, deallocations = 0, lockAcquisitions = 0;
+
+        bool isClean() const noexcept    { return allocations == 0 && deallocations == 0 && lockAcquisitions == 0; }
+    };
+
+    inline thread_local bool inAudioCallback = false;
+
+    inline std::atomic<int> allocations { 0 }, deallocations { 0 }, lockAcquisitions { 0 };
+
+    inline void noteAllocation() noexcept          { if (inAudioCallback) ++allocations; }
+    inline void noteDeallocation() noexcept        { if (inAudioCallback) ++deallocations; }
+    inline void noteLockAcquisition() noexcept     { if (inAudioCallback) ++lockAcquisitions; }
+
+    inline Counts getCounts() noexcept             { return { allocations.load(), deallocations.load(), lockAcquisitions.load() }; }
+
+    inline void resetCounts() noexcept
+    {
+        allocations = 0;
+        deallocations = 0;
+        lockAcquisitions = 0;
+    }
+
+    /** Marks the current thread as running an audio callback for the lifetime of the object. */
+    struct ScopedAudioCallback
+    {
+        ScopedAudioCallback() noexcept  : wasInAudioCallback (inAudioCallback)    { inAudioCallback = true; }
+        ~ScopedAudioCallback() noexcept                                           { inAudioCallback = wasInAudioCallback; }
+
+        ScopedAudioCallback (const ScopedAudioCallback&) = delete;
+        ScopedAudioCallback& operator= (const ScopedAudioCallback&) = delete;
+
+        const bool wasInAudioCallback;
+    };
+}
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    Global allocation and lock hooks feeding RealtimeAudit.
+
+    Only linked into the Tests target and into plugins configured with
+    BASSICMANAGER_REALTIME_AUDIT=ON; never add this to SourceFiles.
+
+  ==============================================================================
+*/
+
+#include "RealtimeAudit.h"
+
+#include <cstdlib>
+#include <new>
+
+#if defined (__linux__)
+ #include <dlfcn.h>
+ #include <pthread.h>
+#endif
+
+#if defined (_MSC_VER)
+ #include <malloc.h>
+#endif
+
+//==============================================================================
+static void* allocateAlignedBlock (std::size_t size, std::size_t alignment) noexcept
+{
+   #if defined (_MSC_VER)
+    return _aligned_malloc (size, alignment);
+   #else
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return std::aligned_alloc (alignment, (size + alignment - 1) / alignment * alignment);
+   #endif
+}
+
+static void freeAlignedBlock (void* p) noexcept
+{
+   #if defined (_MSC_VER)
+    _aligned_free (p);
+   #else
+    std::free (p);
+   #endif
+}
+
+static void* allocate (std::size_t size)
+{
+    RealtimeAudit::noteAllocation();
+
+    if (auto* p = std::malloc (size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+static void* allocate (std::size_t size, std::align_val_t alignment)
+{
+    RealtimeAudit::noteAllocation();
+
+    auto align = static_cast<std::size_t> (alignment);
+
+    if (auto* p = allocateAlignedBlock (size == 0 ? align : size, align))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+static void deallocate (void* p) noexcept
+{
+    if (p == nullptr)
+        return;
+
+    RealtimeAudit::noteDeallocation();
+    std::free (p);
+}
+
+static void deallocateAligned (void* p) noexcept
+{
+    if (p == nullptr)
+        return;
+
+    RealtimeAudit::noteDeallocation();
+    freeAlignedBlock (p);
+}
+
+void* operator new (std::size_t size)                                            { return allocate (size); }
+void* operator new[] (std::size_t size)                                          { return allocate (size); }
+void* operator new (std::size_t size, std::align_val_t a)                        { return allocate (size, a); }
+void* operator new[] (std::size_t size, std::align_val_t a)                      { return allocate (size, a); }
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate (size); } catch (...) { return nullptr; }
+}
+
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate (size); } catch (...) { return nullptr; }
+}
+
+void operator delete (void* p) noexcept                                          { deallocate (p); }
+void operator delete[] (void* p) noexcept                                        { deallocate (p); }
+void operator delete (void* p, std::size_t) noexcept                             { deallocate (p); }
+void operator delete[] (void* p, std::size_t) noexcept                           { deallocate (p); }
+void operator delete (void* p, std::align_val_t) noexcept                        { deallocateAligned (p); }
+void operator delete[] (void* p, std::align_val_t) noexcept                      { deallocateAligned (p); }
+void operator delete (void* p, std::size_t, std::align_val_t) noexcept           { deallocateAligned (p); }
+void operator delete[] (void* p, std::size_t, std::align_val_t) noexcept         { deallocateAligned (p); }
+void operator delete (void* p, const std::nothrow_t&) noexcept                   { deallocate (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept                 { deallocate (p); }
+
+//==============================================================================
+#if defined (__linux__)
+// std::mutex, juce::CriticalSection and friends all end up here. The real function
+// is looked up without a function-local static, whose guard could itself lock.
+using MutexFunction = int (*) (pthread_mutex_t*);
+
+static MutexFunction realMutexLock = nullptr, realMutexTryLock = nullptr;
+
+extern "C" int pthread_mutex_lock (pthread_mutex_t* mutex)
+{
+    if (realMutexLock == nullptr)
+        realMutexLock = reinterpret_cast<MutexFunction> (dlsym (RTLD_NEXT, "pthread_mutex_lock"));
+
+    RealtimeAudit::noteLockAcquisition();
+    return realMutexLock (mutex);
+}
+
+extern "C" int pthread_mutex_trylock (pthread_mutex_t* mutex)
+{
+    if (realMutexTryLock == nullptr)
+        realMutexTryLock = reinterpret_cast<MutexFunction> (dlsym (RTLD_NEXT, "pthread_mutex_trylock"));
+
+    RealtimeAudit::noteLockAcquisition();
+    return realMutexTryLock (mutex);
+}
+#endif
@@ -0,0 +1,179 @@
+/*
+  ==============================================================================
+
+    A few real-time threads the audio thread can hand part of a block to.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "RealtimeAudit.h"
+
+#include <atomic>
+#include <thread>
+
+//==============================================================================
+/**
+    Worker threads that are started ahead of time and sleep until the audio
+    thread hands them a job.
+
+    dispatch() wakes every worker to run the same job with its own index and
+    returns straight away, so the audio thread can get on with its own share;
+    wait() is the barrier that spins until every worker has finished. Both go
+    through atomics only: the workers sleep in std::atomic::wait, which the
+    audio thread's notify wakes without taking a lock, so neither call
+    allocates, locks or puts the audio thread to sleep. The jobs themselves
+    count as part of the audio callback for the real-time audit.
+
+    The workers run at real-time priority where the system allows it. Which
+    cores they run on is left to the scheduler, which can see every other
+    instance's workers and the host's threads.
+*/
+class RealtimeWorkerPool
+{
+public:
+    /** Runs on a worker, with the context given to dispatch() and the worker's index. */
+    using Job = void (*) (void* context, int worker);
+
+    RealtimeWorkerPool() = default;
+
+    ~RealtimeWorkerPool()
+    {
+        stop();
+    }
+
+    /** How many workers are worth starting for numTasks tasks: one for each core
+        besides the audio thread's, and no more than there are tasks to share.
+    */
+    static int getUsefulNumWorkers (int numTasks) noexcept
+    {
+        auto numCores = juce::jmax (juce::SystemStats::getNumCpus(), minimumNumCoresForTesting.load());
+        return juce::jmax (0, juce::jmin (numTasks, numCores) - 1);
+    }
+
+    /** Lets the tests run the workers on machines with fewer cores than tasks. */
+    static inline std::atomic<int> minimumNumCoresForTesting { 0 };
+
+    /** Starts numWorkers threads, replacing any that are running. Call this from
+        prepareToPlay, never from the audio thread. A thread the system refuses to
+        start is left out, so there may be fewer workers than asked for.
+    */
+    void start (int numWorkers)
+    {
+        if (numWorkers == requestedNumWorkers)
+            return;
+
+        stop();
+        requestedNumWorkers = numWorkers;
+
+        for (int i = 0; i < numWorkers; ++i)
+        {
+            auto worker = std::make_unique<Worker> (*this, getNumWorkers());
+
+            if (worker->startRealtimeThread (juce::Thread::RealtimeOptions {})
+                 || worker->startThread (juce::Thread::Priority::highest))
+                workers.push_back (std::move (worker));
+        }
+    }
+
+    /** Stops and joins every worker. Not for the audio thread. */
+    void stop()
+    {
+        for (auto& worker : workers)
+            worker->signalThreadShouldExit();
+
+        generation.fetch_add (1, std::memory_order_release);
+        generation.notify_all();
+
+        for (auto& worker : workers)
+            worker->stopThread (1000);
+
+        workers.clear();
+        requestedNumWorkers = 0;
+    }
+
+    int getNumWorkers() const noexcept      { return (int) workers.size(); }
+
+    //==============================================================================
+    /** Audio thread: has every worker run job, then returns without waiting for them.
+        The previous dispatch must have been waited for.
+    */
+    void dispatch (Job job, void* context) noexcept
+    {
+        jassert (pending.load (std::memory_order_relaxed) == 0);
+
+        currentJob = job;
+        currentContext = context;
+        pending.store (getNumWorkers(), std::memory_order_relaxed);
+
+        // Publishes the job along with the new generation
+        generation.fetch_add (1, std::memory_order_release);
+        generation.notify_all();
+    }
+
+    /** Audio thread: spins until every worker has finished the dispatched job. If that
+        takes a while, a worker has probably been preempted, so the core is offered to
+        it between checks.
+    */
+    void wait() const noexcept
+    {
+        for (int spins = 0; pending.load (std::memory_order_acquire) > 0; ++spins)
+            if (spins >= maximumSpins)
+                std::this_thread::yield();
+    }
+
+private:
+    //==============================================================================
+    class Worker final : public juce::Thread
+    {
+    public:
+        Worker (RealtimeWorkerPool& p, int i)
+            : juce::Thread ("Channel group worker " + juce::String (i)), pool (p), index (i),
+              seen (p.generation.load (std::memory_order_acquire))
+        {
+        }
+
+        void run() override
+        {
+            // Like the audio thread, the workers' filters must never go denormal
+            juce::ScopedNoDenormals noDenormals;
+
+            for (;;)
+            {
+                pool.generation.wait (seen, std::memory_order_acquire);
+                seen = pool.generation.load (std::memory_order_acquire);
+
+                if (threadShouldExit())
+                    return;
+
+                {
+                    RealtimeAudit::ScopedAudioCallback auditedJob;
+                    pool.currentJob (pool.currentContext, index);
+                }
+
+                pool.pending.fetch_sub (1, std::memory_order_release);
+            }
+        }
+
+    private:
+        RealtimeWorkerPool& pool;
+        const int index;
+
+        // Taken before the thread starts, so a dispatch can't slip past it
+        int seen;
+    };
+
+    static constexpr int maximumSpins = 4096;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    int requestedNumWorkers = 0;
+
+    Job currentJob = nullptr;
+    void* currentContext = nullptr;
+    std::atomic<int> generation { 0 }, pending { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeWorkerPool)
+};
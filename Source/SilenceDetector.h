@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    Decides when a channel's filters can be skipped because it has gone quiet.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <atomic>
+
+//==============================================================================
+/**
+    Tracks a group of signal paths (one per main channel, say) and says which of
+    them are idle, i.e. have been silent for at least holdSamples.
+
+    The caller decides what "silent" means for each call, typically that the
+    input is below threshold and the filter state has rung out below it too. A
+    path stops being idle the moment a call reports it isn't silent, and its
+    filters then resume from a state that is already (almost) zero, so there is
+    no click. The hold covers anything that delays a path without showing up in
+    its filter state, such as a latency-compensation delay line.
+
+    Every decision is counted, so callers can report the fraction of path
+    updates that were skipped. The counters are relaxed atomics, written by the
+    audio thread and readable from anywhere.
+*/
+class SilenceDetector
+{
+public:
+    SilenceDetector() = default;
+
+    /** -120 dBFS, well under the noise floor of any 24-bit source. */
+    static constexpr float threshold = 1.0e-6f;
+
+    /** True if every sample is smaller than threshold in magnitude. */
+    template <typename SampleType>
+    static bool isSilent (const SampleType* data, int numSamples) noexcept
+    {
+        auto range = juce::FloatVectorOperations::findMinAndMax (data, numSamples);
+        return -range.getStart() < (SampleType) threshold && range.getEnd() < (SampleType) threshold;
+    }
+
+    /** Allocates the per-path counters and zeroes the statistics. Every path starts out busy. */
+    void prepare (int newNumPaths, int newHoldSamples)
+    {
+        silentSamples.assign ((size_t) newNumPaths, 0);
+        holdSamples = newHoldSamples;
+        skipped = 0;
+        processed = 0;
+    }
+
+    /** Makes every path busy again, e.g. after the filters were reset or reconfigured. */
+    void reset() noexcept
+    {
+        std::fill (silentSamples.begin(), silentSamples.end(), 0);
+    }
+
+    /** Audio thread: records whether the path was silent over numSamples and returns
+        true if its processing can be skipped for them.
+    */
+    bool update (int path, bool isSilentNow, int numSamples) noexcept
+    {
+        auto& run = silentSamples[(size_t) path];
+        run = isSilentNow ? juce::jmin (run + numSamples, holdSamples + numSamples) : 0;
+
+        auto idle = isSilentNow && run > holdSamples;
+        (idle ? skipped : processed).fetch_add (1, std::memory_order_relaxed);
+        return idle;
+    }
+
+    juce::uint64 getNumSkipped() const noexcept      { return skipped.load (std::memory_order_relaxed); }
+    juce::uint64 getNumProcessed() const noexcept    { return processed.load (std::memory_order_relaxed); }
+
+private:
+    std::vector<int> silentSamples;
+    int holdSamples = 0;
+
+    std::atomic<juce::uint64> skipped { 0 }, processed { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SilenceDetector)
+};
@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+    Per-speaker distance delay and level trim.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+//==============================================================================
+/**
+    Delays and trims every output channel, so speakers at different distances
+    arrive together and at matched levels.
+
+    All the delay lines live in one arena allocated by prepare(), each a power
+    of two long so positions wrap with a mask, and they share one write
+    position. A tile goes into a line with at most two copies. A whole-sample
+    delay comes back out with at most two more, and nothing else. A fractional
+    delay is read into a scratch buffer and interpolated with a four-tap
+    Lagrange filter, which is four vectorised multiply-adds over shifted views
+    of that buffer.
+
+    A channel with no delay only has its gain applied, and one with unity gain
+    as well is left untouched. A line is cleared when its channel gets a delay
+    again, so stale samples never come out.
+*/
+template <typename SampleType>
+class SpeakerAlignment
+{
+public:
+    static constexpr double maximumDelaySeconds = 0.05;
+
+    SpeakerAlignment() = default;
+
+    /** Allocates the arena. Call this from prepareToPlay, never from the audio thread.
+
+        extraDelaySamples makes room beyond maximumDelaySeconds, for latency that the
+        caller compensates for on top of the distance delays.
+    */
+    void prepare (double newSampleRate, int newNumChannels, int newMaximumBlockSize, int extraDelaySamples = 0)
+    {
+        jassert (newNumChannels >= 0 && newMaximumBlockSize > 0);
+
+        sampleRate = newSampleRate;
+        numChannels = newNumChannels;
+        maximumBlockSize = newMaximumBlockSize;
+
+        // The longest delay, plus the block being written, plus the interpolator's taps
+        maximumDelay = (int) std::ceil (sampleRate * maximumDelaySeconds) + extraDelaySamples;
+        lineLength = juce::nextPowerOfTwo (maximumDelay + maximumBlockSize + numTaps);
+        mask = lineLength - 1;
+
+        arena.assign ((size_t) (numChannels * lineLength), SampleType (0));
+        scratch.assign ((size_t) (maximumBlockSize + numTaps), SampleType (0));
+        channels.assign ((size_t) numChannels, Channel {});
+        writePosition = 0;
+        active = false;
+    }
+
+    /** Clears every line and jumps the gains to their targets. */
+    void reset() noexcept
+    {
+        std::fill (arena.begin(), arena.end(), SampleType (0));
+
+        for (auto& c : channels)
+            c.gain = c.targetGain;
+    }
+
+    int getNumChannels() const noexcept     { return numChannels; }
+
+    /** False if every channel would pass through untouched. */
+    bool isActive() const noexcept          { return active; }
+
+    /** Delays a channel by delayInSamples, up to maximumDelaySeconds plus the extra room. Takes effect at once. */
+    void setDelay (int channel, double delayInSamples) noexcept
+    {
+        auto& c = channels[(size_t) channel];
+        auto usedLine = c.usesLine();
+
+        delayInSamples = juce::jlimit (0.0, (double) maximumDelay, delayInSamples);
+        auto wholeSamples = (int) delayInSamples;
+        auto fraction = delayInSamples - wholeSamples;
+
+        c.wholeSamples = wholeSamples;
+        c.isFractional = fraction > 0.0;
+
+        if (c.isFractional)
+        {
+            // The taps sit one sample either side of the delay where possible, the
+            // centre of a third order Lagrange interpolator's range
+            c.firstTap = juce::jmax (wholeSamples - 1, 0);
+            setLagrangeTaps (c, delayInSamples - c.firstTap);
+        }
+
+        if (c.usesLine() && ! usedLine)
+            std::fill (getLine (channel), getLine (channel) + lineLength, SampleType (0));
+
+        updateActive();
+    }
+
+    /** Sets a channel's linear gain, ramped to over the next block. */
+    void setGain (int channel, SampleType newGain) noexcept
+    {
+        channels[(size_t) channel].targetGain = newGain;
+        updateActive();
+    }
+
+    //==============================================================================
+    /** Delays and trims numSamples of every channel from startSample on, in place.
+        numSamples can't be more than the prepared maximum block size.
+    */
+    void process (SampleType* const* channelData, int startSample, int numSamples) noexcept
+    {
+        jassert (numSamples <= maximumBlockSize);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& c = channels[(size_t) ch];
+            auto* data = channelData[ch] + startSample;
+
+            if (c.usesLine())
+                delay (ch, c, data, numSamples);
+
+            applyGain (c, data, numSamples);
+        }
+
+        writePosition = (writePosition + numSamples) & mask;
+    }
+
+private:
+    //==============================================================================
+    static constexpr int numTaps = 4;
+
+    struct Channel
+    {
+        int wholeSamples = 0, firstTap = 0;
+        bool isFractional = false;
+        SampleType taps[numTaps] = {};
+        SampleType gain = 1, targetGain = 1;
+
+        bool usesLine() const noexcept      { return wholeSamples > 0 || isFractional; }
+        bool isBypassed() const noexcept    { return ! usesLine() && gain == SampleType (1) && targetGain == SampleType (1); }
+    };
+
+    SampleType* getLine (int channel) noexcept     { return arena.data() + channel * lineLength; }
+
+    static void setLagrangeTaps (Channel& c, double d) noexcept
+    {
+        // Tap k is k samples older than the first; d is the delay from the first tap
+        c.taps[0] = (SampleType) (-(d - 1.0) * (d - 2.0) * (d - 3.0) / 6.0);
+        c.taps[1] = (SampleType) (d * (d - 2.0) * (d - 3.0) / 2.0);
+        c.taps[2] = (SampleType) (-d * (d - 1.0) * (d - 3.0) / 2.0);
+        c.taps[3] = (SampleType) (d * (d - 1.0) * (d - 2.0) / 6.0);
+    }
+
+    void delay (int channel, const Channel& c, SampleType* data, int numSamples) noexcept
+    {
+        auto* line = getLine (channel);
+        copyIntoLine (data, line, writePosition, numSamples);
+
+        if (! c.isFractional)
+        {
+            copyFromLine (line, writePosition - c.wholeSamples, data, numSamples);
+            return;
+        }
+
+        // scratch[i + numTaps - 1 - k] is the input to tap k for output sample i
+        auto* x = scratch.data();
+        copyFromLine (line, writePosition - c.firstTap - (numTaps - 1), x, numSamples + numTaps - 1);
+
+        juce::FloatVectorOperations::copyWithMultiply (data, x + 3, c.taps[0], numSamples);
+        juce::FloatVectorOperations::addWithMultiply (data, x + 2, c.taps[1], numSamples);
+        juce::FloatVectorOperations::addWithMultiply (data, x + 1, c.taps[2], numSamples);
+        juce::FloatVectorOperations::addWithMultiply (data, x, c.taps[3], numSamples);
+    }
+
+    static void applyGain (Channel& c, SampleType* data, int numSamples) noexcept
+    {
+        if (c.gain != c.targetGain)
+        {
+            auto increment = (c.targetGain - c.gain) / (SampleType) numSamples;
+
+            for (int i = 0; i < numSamples; ++i)
+                data[i] *= c.gain + increment * (SampleType) (i + 1);
+
+            c.gain = c.targetGain;
+        }
+        else if (c.gain != SampleType (1))
+        {
+            juce::FloatVectorOperations::multiply (data, c.gain, numSamples);
+        }
+    }
+
+    void copyIntoLine (const SampleType* source, SampleType* line, int position, int numSamples) const noexcept
+    {
+        position &= mask;
+        auto first = juce::jmin (numSamples, lineLength - position);
+        std::copy (source, source + first, line + position);
+        std::copy (source + first, source + numSamples, line);
+    }
+
+    void copyFromLine (const SampleType* line, int position, SampleType* destination, int numSamples) const noexcept
+    {
+        position &= mask;
+        auto first = juce::jmin (numSamples, lineLength - position);
+        std::copy (line + position, line + position + first, destination);
+        std::copy (line, line + (numSamples - first), destination + first);
+    }
+
+    void updateActive() noexcept
+    {
+        active = std::any_of (channels.begin(), channels.end(), [] (const Channel& c) { return ! c.isBypassed(); });
+    }
+
+    //==============================================================================
+    std::vector<SampleType> arena, scratch;
+    std::vector<Channel> channels;
+    double sampleRate = 44100.0;
+    int numChannels = 0, maximumBlockSize = 0, maximumDelay = 0;
+    int lineLength = 0, mask = 0, writePosition = 0;
+    bool active = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpeakerAlignment)
+};
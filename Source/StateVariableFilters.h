@@ -0,0 +1,421 @@
+/*
+  ==============================================================================
+
+    Topology-preserving transform crossover filters with per-sample cutoff.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <numeric>
+
+#include "ChannelLanes.h"
+
+//==============================================================================
+/**
+    The warped cutoff g = tan (pi * fc / fs) of a TPT filter, ramped once per
+    sample towards its target.
+
+    The target costs one tan() when it changes; every sample after that is a
+    single multiply, because the ramp is multiplicative. Over the crossover range
+    g is almost exactly proportional to fc, so the ramp is a straight line in
+    log-frequency. TPT filters stay stable for any g > 0, so the cutoff can move
+    as fast as the ramp allows without the blow-ups a direct form biquad shows
+    when its coefficients are modulated.
+*/
+template <typename SampleType>
+class TPTCutoff
+{
+public:
+    void prepare (double newSampleRate, double rampLengthSeconds) noexcept
+    {
+        sampleRate = newSampleRate;
+        targetFrequency = 0;
+        warped.reset (sampleRate, rampLengthSeconds);
+        snapToTarget();
+    }
+
+    /** Starts a ramp towards a new cutoff frequency in Hz. */
+    void setFrequency (SampleType frequency) noexcept
+    {
+        if (frequency == targetFrequency)
+            return;
+
+        jassert (frequency > 0 && frequency < sampleRate * 0.5);
+        targetFrequency = frequency;
+        warped.setTargetValue (static_cast<SampleType> (std::tan (juce::MathConstants<double>::pi * frequency / sampleRate)));
+    }
+
+    /** Jumps straight to the current target. */
+    void snapToTarget() noexcept    { warped.setCurrentAndTargetValue (warped.getTargetValue()); }
+
+    SampleType getNextValue() noexcept    { return warped.getNextValue(); }
+
+private:
+    juce::SmoothedValue<SampleType, juce::ValueSmoothingTypes::Multiplicative> warped { SampleType (1) };
+    SampleType targetFrequency = 0;
+    double sampleRate = 44100.0;
+};
+
+//==============================================================================
+/**
+    A cascade of TPT one-pole high-passes run over a group of channels with a
+    cutoff that can change every sample.
+
+    With a fixed cutoff each section has exactly the response of a bilinear first
+    order Butterworth high-pass, so it is a drop-in alternative to a
+    MultichannelBiquadCascade built from makeFirstOrderHighPass sections. The
+    per-sample gain G = g / (1 + g) is shared by every channel and section, so
+    the ramp costs one division per sample. Channels are packed into SIMD lanes
+    the same way as in MultichannelBiquadCascade, including the option to
+    filter only a list of active channels.
+*/
+template <typename SampleType>
+class TPTHighPassCascade
+{
+    using Lanes = ChannelLanes<SampleType>;
+   #if JUCE_USE_SIMD
+    using Vector = typename Lanes::Vector;
+   #endif
+
+public:
+    /** Allocates the state block. Call this from prepareToPlay, never from the audio thread. */
+    void prepare (double sampleRate, int newNumChannels, int newNumSections,
+                  int newMaximumBlockSize, double rampLengthSeconds)
+    {
+        jassert (newNumChannels > 0 && newNumSections > 0 && newMaximumBlockSize > 0);
+
+        numChannels = newNumChannels;
+        numSections = newNumSections;
+        maximumBlockSize = newMaximumBlockSize;
+
+        cutoff.prepare (sampleRate, rampLengthSeconds);
+        gains.assign ((size_t) maximumBlockSize, SampleType (0));
+        state.assign ((size_t) (numSections * numChannels), SampleType (0));
+
+        allChannels.resize ((size_t) numChannels);
+        std::iota (allChannels.begin(), allChannels.end(), 0);
+        activeChannelData.assign ((size_t) numChannels, nullptr);
+
+       #if JUCE_USE_SIMD
+        interleaved.assign ((size_t) maximumBlockSize, Vector::expand (0));
+       #else
+        interleaved.assign ((size_t) maximumBlockSize, SampleType (0));
+       #endif
+    }
+
+    /** Clears every channel's state and jumps the cutoff to its target. */
+    void reset() noexcept
+    {
+        std::fill (state.begin(), state.end(), SampleType (0));
+        cutoff.snapToTarget();
+    }
+
+    /** True if every section of the channel has a state smaller than threshold. */
+    bool isChannelStateBelow (int channel, SampleType threshold) const noexcept
+    {
+        for (int section = 0; section < numSections; ++section)
+            if (std::abs (state[(size_t) (section * numChannels + channel)]) >= threshold)
+                return false;
+
+        return true;
+    }
+
+    int getNumChannels() const noexcept     { return numChannels; }
+    int getNumSections() const noexcept     { return numSections; }
+
+    /** Ramps the cutoff of every section towards frequency over the following samples. */
+    void setCutoffFrequency (SampleType frequency) noexcept     { cutoff.setFrequency (frequency); }
+
+    /** Filters numSamples of every channel in place; channelData must hold getNumChannels() pointers. */
+    void process (SampleType* const* channelData, int numSamples) noexcept
+    {
+        process (channelData, allChannels.data(), numChannels, numSamples);
+    }
+
+    /** Filters only the numActive channels listed in channels. The cutoff ramp advances
+        for everyone, so an idle channel picks up at the current cutoff when it returns.
+    */
+    void process (SampleType* const* channelData, const int* channels, int numActive, int numSamples) noexcept
+    {
+        jassert (numActive <= numChannels);
+
+        for (int k = 0; k < numActive; ++k)
+            activeChannelData[(size_t) k] = channelData[channels[k]];
+
+        for (int start = 0; start < numSamples; start += maximumBlockSize)
+        {
+            auto num = juce::jmin (maximumBlockSize, numSamples - start);
+
+            for (int i = 0; i < num; ++i)
+            {
+                auto g = cutoff.getNextValue();
+                gains[(size_t) i] = g / (SampleType (1) + g);
+            }
+
+            auto* raw = reinterpret_cast<SampleType*> (interleaved.data());
+
+            for (int first = 0; first < numActive; first += Lanes::size)
+            {
+                Lanes::gather (activeChannelData.data(), first, numActive, start, num, raw);
+                processVector (channels + first, juce::jmin (Lanes::size, numActive - first), num);
+                Lanes::scatter (raw, activeChannelData.data(), first, numActive, start, num);
+            }
+        }
+    }
+
+private:
+   #if JUCE_USE_SIMD
+    void processVector (const int* laneChannels, int numLanes, int num) noexcept
+    {
+        for (int section = 0; section < numSections; ++section)
+        {
+            auto* z = state.data() + section * numChannels;
+            auto s = Vector::expand (0);
+
+            for (int l = 0; l < numLanes; ++l)
+                s.set ((size_t) l, z[laneChannels[l]]);
+
+            for (int i = 0; i < num; ++i)
+            {
+                auto x = interleaved[(size_t) i];
+                auto v = (x - s) * Vector::expand (gains[(size_t) i]);
+                auto lowPass = v + s;
+                s = lowPass + v;
+                interleaved[(size_t) i] = x - lowPass;
+            }
+
+            for (int l = 0; l < numLanes; ++l)
+                z[laneChannels[l]] = s.get ((size_t) l);
+        }
+    }
+
+    std::vector<Vector> interleaved;
+   #else
+    void processVector (const int* laneChannels, int, int num) noexcept
+    {
+        for (int section = 0; section < numSections; ++section)
+        {
+            auto& s = state[(size_t) (section * numChannels + laneChannels[0])];
+
+            for (int i = 0; i < num; ++i)
+            {
+                auto x = interleaved[(size_t) i];
+                auto v = (x - s) * gains[(size_t) i];
+                auto lowPass = v + s;
+                s = lowPass + v;
+                interleaved[(size_t) i] = x - lowPass;
+            }
+        }
+    }
+
+    std::vector<SampleType> interleaved;
+   #endif
+
+    TPTCutoff<SampleType> cutoff;
+    std::vector<SampleType> gains, state;
+    std::vector<int> allChannels;
+    std::vector<SampleType*> activeChannelData;
+    int numChannels = 0, numSections = 0, maximumBlockSize = 0;
+
+    JUCE_LEAK_DETECTOR (TPTHighPassCascade)
+};
+
+//==============================================================================
+/**
+    A fourth order Linkwitz-Riley low-pass made of two TPT state-variable
+    Butterworth stages, with a cutoff that can change every sample.
+
+    With a fixed cutoff the response matches juce::dsp::LinkwitzRileyFilter; the
+    difference is that the cutoff follows a per-sample ramp instead of moving in
+    steps at block boundaries.
+*/
+template <typename SampleType>
+class TPTLinkwitzRileyLowPass
+{
+public:
+    void prepare (double sampleRate, double rampLengthSeconds) noexcept
+    {
+        cutoff.prepare (sampleRate, rampLengthSeconds);
+        reset();
+    }
+
+    /** Clears the state and jumps the cutoff to its target. */
+    void reset() noexcept
+    {
+        s1 = s2 = s3 = s4 = 0;
+        cutoff.snapToTarget();
+    }
+
+    /** Ramps the cutoff towards frequency over the following samples. */
+    void setCutoffFrequency (SampleType frequency) noexcept     { cutoff.setFrequency (frequency); }
+
+    void process (SampleType* data, int numSamples) noexcept
+    {
+        // Damping 2R = sqrt (2) gives each stage a Butterworth response
+        const auto k = juce::MathConstants<SampleType>::sqrt2;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto g = cutoff.getNextValue();
+            auto h = SampleType (1) / (SampleType (1) + g * (g + k));
+
+            data[i] = processStage (processStage (data[i], g, k, h, s1, s2), g, k, h, s3, s4);
+        }
+    }
+
+private:
+    static SampleType processStage (SampleType x, SampleType g, SampleType k, SampleType h,
+                                    SampleType& z1, SampleType& z2) noexcept
+    {
+        auto highPass = (x - (k + g) * z1 - z2) * h;
+        auto v1 = g * highPass;
+        auto bandPass = v1 + z1;
+        z1 = bandPass + v1;
+        auto v2 = g * bandPass;
+        auto lowPass = v2 + z2;
+        z2 = lowPass + v2;
+        return lowPass;
+    }
+
+    TPTCutoff<SampleType> cutoff;
+    SampleType s1 = 0, s2 = 0, s3 = 0, s4 = 0;
+
+    JUCE_LEAK_DETECTOR (TPTLinkwitzRileyLowPass)
+};
+
+//==============================================================================
+/**
+    A low-pass built from up to four TPT state-variable sections, each with its
+    own damping, followed by up to two TPT one-poles, all at one cutoff.
+
+    This covers the low-pass half of every Butterworth and Linkwitz-Riley
+    crossover. With the same cutoff and Qs it has exactly the response of the
+    matching bilinear biquads, but it stays accurate in single precision when the
+    cutoff is a tiny fraction of the sample rate, where a direct form biquad's
+    coefficients can't place its poles precisely enough.
+
+    Every combination of section counts has a kernel instantiated for it, which
+    is picked by setSections(), so the sample loop never looks at the counts.
+    A new cutoff takes effect at once and costs one tan().
+*/
+template <typename SampleType>
+class TPTLowPassCascade
+{
+public:
+    static constexpr int maxSecondOrderSections = 4;
+    static constexpr int maxFirstOrderSections = 2;
+
+    void prepare (double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::fill (std::begin (z1), std::end (z1), SampleType (0));
+        std::fill (std::begin (z2), std::end (z2), SampleType (0));
+        std::fill (std::begin (onePoleState), std::end (onePoleState), SampleType (0));
+    }
+
+    /** Switches to numSecondOrder state-variable sections with the given dampings (1 / Q),
+        then numFirstOrder one-poles. Clears the state. Call setCutoffFrequency() after this.
+    */
+    void setSections (int newNumSecondOrder, const SampleType* newDampings, int newNumFirstOrder) noexcept
+    {
+        jassert (juce::isPositiveAndNotGreaterThan (newNumSecondOrder, maxSecondOrderSections));
+        jassert (juce::isPositiveAndNotGreaterThan (newNumFirstOrder, maxFirstOrderSections));
+        jassert (newNumSecondOrder + newNumFirstOrder > 0);
+
+        numSecondOrder = newNumSecondOrder;
+        numFirstOrder = newNumFirstOrder;
+        std::copy (newDampings, newDampings + numSecondOrder, dampings);
+        kernel = getKernel (numSecondOrder, numFirstOrder);
+        reset();
+    }
+
+    void setCutoffFrequency (SampleType frequency) noexcept
+    {
+        jassert (frequency > 0 && frequency < sampleRate * 0.5);
+
+        g = static_cast<SampleType> (std::tan (juce::MathConstants<double>::pi * frequency / sampleRate));
+        onePoleGain = g / (SampleType (1) + g);
+
+        for (int s = 0; s < numSecondOrder; ++s)
+            h[s] = SampleType (1) / (SampleType (1) + g * (g + dampings[s]));
+    }
+
+    void process (SampleType* data, int numSamples) noexcept
+    {
+        jassert (kernel != nullptr);
+        (this->*kernel) (data, numSamples);
+    }
+
+private:
+    using Kernel = void (TPTLowPassCascade::*) (SampleType*, int) noexcept;
+
+    template <int NumSecondOrder, int NumFirstOrder>
+    void processFixed (SampleType* data, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = data[i];
+
+            for (int s = 0; s < NumSecondOrder; ++s)
+            {
+                auto highPass = (x - (dampings[s] + g) * z1[s] - z2[s]) * h[s];
+                auto v1 = g * highPass;
+                auto bandPass = v1 + z1[s];
+                z1[s] = bandPass + v1;
+                auto v2 = g * bandPass;
+                x = v2 + z2[s];
+                z2[s] = x + v2;
+            }
+
+            for (int s = 0; s < NumFirstOrder; ++s)
+            {
+                auto v = (x - onePoleState[s]) * onePoleGain;
+                x = v + onePoleState[s];
+                onePoleState[s] = x + v;
+            }
+
+            data[i] = x;
+        }
+    }
+
+    static Kernel getKernel (int secondOrder, int firstOrder) noexcept
+    {
+        switch (secondOrder * (maxFirstOrderSections + 1) + firstOrder)
+        {
+            case 1:     return &TPTLowPassCascade::processFixed<0, 1>;
+            case 2:     return &TPTLowPassCascade::processFixed<0, 2>;
+            case 3:     return &TPTLowPassCascade::processFixed<1, 0>;
+            case 4:     return &TPTLowPassCascade::processFixed<1, 1>;
+            case 5:     return &TPTLowPassCascade::processFixed<1, 2>;
+            case 6:     return &TPTLowPassCascade::processFixed<2, 0>;
+            case 7:     return &TPTLowPassCascade::processFixed<2, 1>;
+            case 8:     return &TPTLowPassCascade::processFixed<2, 2>;
+            case 9:     return &TPTLowPassCascade::processFixed<3, 0>;
+            case 10:    return &TPTLowPassCascade::processFixed<3, 1>;
+            case 11:    return &TPTLowPassCascade::processFixed<3, 2>;
+            case 12:    return &TPTLowPassCascade::processFixed<4, 0>;
+            case 13:    return &TPTLowPassCascade::processFixed<4, 1>;
+            case 14:    return &TPTLowPassCascade::processFixed<4, 2>;
+            default:    jassertfalse; return nullptr;
+        }
+    }
+
+    SampleType dampings[maxSecondOrderSections] = {}, h[maxSecondOrderSections] = {};
+    SampleType z1[maxSecondOrderSections] = {}, z2[maxSecondOrderSections] = {};
+    SampleType onePoleState[maxFirstOrderSections] = {};
+    SampleType g = 0, onePoleGain = 0;
+    Kernel kernel = nullptr;
+    int numSecondOrder = 0, numFirstOrder = 0;
+    double sampleRate = 44100.0;
+
+    JUCE_LEAK_DETECTOR (TPTLowPassCascade)
+};
@@ -0,0 +1,197 @@
+/*
+  ==============================================================================
+
+    The per-subwoofer low-pass and gain stages, run as one SIMD bank.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <juce_dsp/juce_dsp.h>
+
+#include "ChannelLanes.h"
+
+//==============================================================================
+/**
+    Feeds several subwoofers from one bass signal, each through its own fourth
+    order Linkwitz-Riley low-pass and gain (a negative gain inverts it). The
+    low-pass is two Butterworth state-variable sections, the same TPT structure
+    as TPTLowPassCascade, which stays accurate in single precision down to the
+    lowest cutoffs.
+
+    The subwoofers are packed into the lanes of a juce::dsp::SIMDRegister like
+    the channels of MultichannelBiquadCascade, but here every lane has its own
+    coefficients and they all read the same input. Each bass sample is
+    broadcast to every lane as it is read, so the signal is fanned out without
+    being copied per subwoofer, and one pass over the tile runs up to
+    SIMDRegister::size() complete chains. Up to that many subwoofers cost the
+    same as one.
+
+    Retuning a subwoofer only recomputes two scalars for its lane, so it neither
+    allocates nor looks anything up. A new cutoff takes effect at once; gains
+    ramp over the next block.
+*/
+template <typename SampleType>
+class SubwooferBank
+{
+public:
+    SubwooferBank() = default;
+
+    /** Allocates the bank. Call this from prepareToPlay, never from the audio thread. */
+    void prepare (double newSampleRate, int newNumSubwoofers, int newMaximumBlockSize)
+    {
+        jassert (newNumSubwoofers >= 0 && newMaximumBlockSize > 0);
+
+        sampleRate = newSampleRate;
+        numSubwoofers = newNumSubwoofers;
+        maximumBlockSize = newMaximumBlockSize;
+
+        lanes.assign ((size_t) Lanes::getNumVectors (numSubwoofers), LaneGroup {});
+        interleaved.assign ((size_t) maximumBlockSize, broadcast (0));
+
+        for (int sub = 0; sub < numSubwoofers; ++sub)
+            setLowPassFrequency (sub, SampleType (250));
+    }
+
+    /** Clears every filter state and jumps the gains to their targets. */
+    void reset() noexcept
+    {
+        for (auto& group : lanes)
+        {
+            for (int section = 0; section < numSections; ++section)
+                group.z1[section] = group.z2[section] = broadcast (0);
+
+            group.gain = group.targetGain;
+        }
+    }
+
+    int getNumSubwoofers() const noexcept    { return numSubwoofers; }
+
+    /** Retunes one subwoofer's low-pass. */
+    void setLowPassFrequency (int subwoofer, SampleType frequency) noexcept
+    {
+        jassert (frequency > 0 && frequency < sampleRate * 0.5);
+
+        auto g = static_cast<SampleType> (std::tan (juce::MathConstants<double>::pi * frequency / sampleRate));
+        auto& group = lanes[(size_t) (subwoofer / Lanes::size)];
+        auto lane = subwoofer % Lanes::size;
+
+        setLane (group.g, lane, g);
+        setLane (group.h, lane, SampleType (1) / (SampleType (1) + g * (g + damping)));
+    }
+
+    /** Sets one subwoofer's linear gain, negative to invert its polarity. */
+    void setGain (int subwoofer, SampleType newGain) noexcept
+    {
+        setLane (lanes[(size_t) (subwoofer / Lanes::size)].targetGain, subwoofer % Lanes::size, newGain);
+    }
+
+    /** True if every filter state is smaller than threshold, so a silent input gives (almost) silence. */
+    bool isStateBelow (SampleType threshold) const noexcept
+    {
+        for (int sub = 0; sub < numSubwoofers; ++sub)
+        {
+            auto& group = lanes[(size_t) (sub / Lanes::size)];
+            auto lane = sub % Lanes::size;
+
+            for (int section = 0; section < numSections; ++section)
+                if (std::abs (getLane (group.z1[section], lane)) >= threshold || std::abs (getLane (group.z2[section], lane)) >= threshold)
+                    return false;
+        }
+
+        return true;
+    }
+
+    //==============================================================================
+    /** Filters numSamples of bass into every subwoofer channel from startSample on.
+        subwooferData must hold getNumSubwoofers() pointers, and numSamples can't be
+        more than the prepared maximum block size.
+    */
+    void process (const SampleType* bass, SampleType* const* subwooferData, int startSample, int numSamples) noexcept
+    {
+        jassert (numSamples <= maximumBlockSize);
+
+        auto* raw = reinterpret_cast<SampleType*> (interleaved.data());
+        auto rampScale = broadcast (SampleType (1) / (SampleType) numSamples);
+        auto k = broadcast (damping);
+
+        for (size_t l = 0; l < lanes.size(); ++l)
+        {
+            auto& group = lanes[l];
+            auto g = group.g, h = group.h, feedback = group.g + k;
+            auto z1a = group.z1[0], z2a = group.z2[0], z1b = group.z1[1], z2b = group.z2[1];
+            auto gain = group.gain;
+            auto increment = (group.targetGain - group.gain) * rampScale;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto x = broadcast (bass[i]);
+
+                // Two identical state-variable sections, as in TPTLowPassCascade
+                auto v1 = g * ((x - feedback * z1a - z2a) * h);
+                auto bandPass = v1 + z1a;
+                z1a = bandPass + v1;
+                auto v2 = g * bandPass;
+                x = v2 + z2a;
+                z2a = x + v2;
+
+                v1 = g * ((x - feedback * z1b - z2b) * h);
+                bandPass = v1 + z1b;
+                z1b = bandPass + v1;
+                v2 = g * bandPass;
+                x = v2 + z2b;
+                z2b = x + v2;
+
+                gain = gain + increment;
+                interleaved[(size_t) i] = x * gain;
+            }
+
+            group.z1[0] = z1a;
+            group.z2[0] = z2a;
+            group.z1[1] = z1b;
+            group.z2[1] = z2b;
+            group.gain = group.targetGain;
+
+            Lanes::scatter (raw, subwooferData, (int) l * Lanes::size, numSubwoofers, startSample, numSamples);
+        }
+    }
+
+private:
+    //==============================================================================
+    using Lanes = ChannelLanes<SampleType>;
+
+   #if JUCE_USE_SIMD
+    using Vector = typename Lanes::Vector;
+
+    static Vector broadcast (SampleType value) noexcept                           { return Vector::expand (value); }
+    static void setLane (Vector& v, int lane, SampleType value) noexcept          { v.set ((size_t) lane, value); }
+    static SampleType getLane (const Vector& v, int lane) noexcept                { return v.get ((size_t) lane); }
+   #else
+    using Vector = SampleType;
+
+    static Vector broadcast (SampleType value) noexcept                           { return value; }
+    static void setLane (Vector& v, int, SampleType value) noexcept               { v = value; }
+    static SampleType getLane (const Vector& v, int) noexcept                     { return v; }
+   #endif
+
+    static constexpr int numSections = 2;
+
+    // Both sections are Butterworth: a damping (1 / Q) of sqrt (2)
+    static constexpr SampleType damping = static_cast<SampleType> (1.4142135623730951);
+
+    /** The coefficients, states and gains of one register's worth of subwoofers. */
+    struct LaneGroup
+    {
+        Vector g = broadcast (0), h = broadcast (0);
+        Vector z1[numSections] = { broadcast (0), broadcast (0) }, z2[numSections] = { broadcast (0), broadcast (0) };
+        Vector gain = broadcast (1), targetGain = broadcast (1);
+    };
+
+    std::vector<LaneGroup> lanes;
+    std::vector<Vector> interleaved;
+    double sampleRate = 44100.0;
+    int numSubwoofers = 0, maximumBlockSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SubwooferBank)
+};
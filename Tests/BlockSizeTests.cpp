@@ -0,0 +1,106 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+TEST_CASE("Output doesn't depend on the host block size", "[blockSize]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    double sampleRate = 48000.0;
+    int lengthInSamples = 20000;
+
+    juce::AudioBuffer<float> input(6, lengthInSamples);
+    juce::Random random(7);
+
+    for(int ch=0; ch<6; ++ch)
+        for(int i=0; i<lengthInSamples; ++i)
+            input.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+    for(auto multiRate : { 0.0f, 1.0f })
+    {
+        juce::AudioBuffer<float> reference;
+        reference.makeCopyOf(input);
+
+        BassicManagerAudioProcessor referenceProcessor;
+        setParameter(referenceProcessor, "multiRate", multiRate);
+        referenceProcessor.prepareToPlay(sampleRate, 1);
+        processInBlocks(referenceProcessor, reference, 1);
+
+        // Smaller than, straddling and much larger than a tile, and larger than prepared
+        for(auto blockSize : { 37, 256, 300, 4096 })
+        {
+            juce::AudioBuffer<float> actual;
+            actual.makeCopyOf(input);
+
+            BassicManagerAudioProcessor processor;
+            setParameter(processor, "multiRate", multiRate);
+            processor.prepareToPlay(sampleRate, juce::jmin(blockSize, 512));
+            processInBlocks(processor, actual, blockSize);
+
+            for(int ch=0; ch<6; ++ch)
+            {
+                float maxError = 0.0f;
+
+                for(int i=0; i<lengthInSamples; ++i)
+                    maxError = juce::jmax(maxError, std::abs(actual.getSample(ch, i) - reference.getSample(ch, i)));
+
+                CHECK(maxError < 1.0e-5f);
+            }
+        }
+    }
+}
+
+TEST_CASE("Automation lands on the same samples whatever the host block size", "[blockSize]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    double sampleRate = 48000.0;
+    int changeAt = 8192;
+    int lengthInSamples = 16384;
+
+    juce::AudioBuffer<float> input(6, lengthInSamples);
+    juce::Random random(8);
+
+    for(int ch=0; ch<6; ++ch)
+        for(int i=0; i<lengthInSamples; ++i)
+            input.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+    // The crossover moves at the same sample for every host, then glides over many blocks
+    auto render = [&](int blockSize, float topology)
+    {
+        juce::AudioBuffer<float> output;
+        output.makeCopyOf(input);
+
+        BassicManagerAudioProcessor processor;
+        setParameter(processor, "crossoverTopology", topology);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        juce::AudioBuffer<float> head(output.getArrayOfWritePointers(), 6, 0, changeAt);
+        juce::AudioBuffer<float> tail(output.getArrayOfWritePointers(), 6, changeAt, lengthInSamples - changeAt);
+
+        processInBlocks(processor, head, blockSize);
+        setParameter(processor, "crossoverFrequency", 200.0f);
+        setParameter(processor, "lfeLowPassFrequency", 40.0f);
+        processInBlocks(processor, tail, blockSize);
+
+        return output;
+    };
+
+    for(auto topology : { 0.0f, 1.0f })
+    {
+        auto reference = render(32, topology);
+
+        for(auto blockSize : { 64, 128, 512, 1024, 8192 })
+        {
+            auto actual = render(blockSize, topology);
+
+            for(int ch=0; ch<6; ++ch)
+            {
+                float maxError = 0.0f;
+
+                for(int i=0; i<lengthInSamples; ++i)
+                    maxError = juce::jmax(maxError, std::abs(actual.getSample(ch, i) - reference.getSample(ch, i)));
+
+                CHECK(maxError < 1.0e-5f);
+            }
+        }
+    }
+}
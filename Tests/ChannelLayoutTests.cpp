@@ -0,0 +1,64 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+static bool setLayout(juce::AudioProcessor& processor, const juce::AudioChannelSet& set)
+{
+    return processor.setBusesLayout(BassicManagerAudioProcessor::makeBusesLayout(set));
+}
+
+static float getRMSDecibels(const juce::AudioBuffer<float>& buffer, int channel, int start)
+{
+    return juce::Decibels::gainToDecibels(buffer.getRMSLevel(channel, start, buffer.getNumSamples() - start));
+}
+
+TEST_CASE("Only surround layouts with a channel map are supported", "[layouts]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    BassicManagerAudioProcessor processor;
+
+    for(auto& set : BassManagementChannelMap::getSupportedLayouts())
+        CHECK(setLayout(processor, set));
+
+    CHECK_FALSE(setLayout(processor, juce::AudioChannelSet::stereo()));
+    CHECK_FALSE(setLayout(processor, juce::AudioChannelSet::discreteChannels(6)));
+}
+
+TEST_CASE("Bass management follows the negotiated layout", "[layouts]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    double sampleRate = 48000.0;
+    int blockSize = 480;
+    int lengthInSamples = 48000;
+
+    for(auto& set : BassManagementChannelMap::getSupportedLayouts())
+    {
+        BassicManagerAudioProcessor processor;
+        REQUIRE(setLayout(processor, set));
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        auto numChannels = set.size();
+        auto lfe = set.getChannelIndexForType(juce::AudioChannelSet::LFE);
+
+        for(auto frequency : { 30.0, 1000.0 })
+        {
+            juce::AudioBuffer<float> buffer(numChannels, lengthInSamples);
+
+            for(int ch=0; ch<numChannels; ++ch)
+                for(int i=0; i<lengthInSamples; ++i)
+                    buffer.setSample(ch, i, (float)std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate));
+
+            processInBlocks(processor, buffer, blockSize);
+
+            // Skip the first half while the filters settle
+            for(int ch=0; ch<numChannels; ++ch)
+            {
+                auto level = getRMSDecibels(buffer, ch, lengthInSamples / 2);
+
+                if(frequency < 100.0)
+                    CHECK((ch == lfe ? level >= -3.0f : level <= -40.0f));
+                else
+                    CHECK((ch == lfe ? level <= -40.0f : level >= -3.5f));
+            }
+        }
+    }
+}
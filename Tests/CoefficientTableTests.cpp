@@ -0,0 +1,87 @@
+#include "catch2/catch.hpp"
+#include <CoefficientTable.h>
+
+#include <thread>
+
+TEST_CASE("Coefficient table matches a fresh design", "[coefficientTable]") {
+    using Table = CrossoverCoefficientTable<float>;
+
+    for(auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+    {
+        Table table;
+        table.prepare(sampleRate);
+
+        for(int s=0; s<numCrossoverSlopes; ++s)
+        {
+            std::vector<Table::Section> expected;
+            double maxError = 0.0;
+
+            // Off-grid frequencies across the whole parameter range
+            for(float frequency = 20.0f; frequency <= 250.0f; frequency += 3.7f)
+            {
+                Table::Section actual[Table::maximumNumSections];
+                auto numSections = table.getHighPass((CrossoverSlope) s, frequency, actual);
+                Table::design((CrossoverSlope) s, true, sampleRate, frequency, expected);
+                REQUIRE(numSections == (int) expected.size());
+
+                for(int i=0; i<numSections; ++i)
+                {
+                    auto& a = actual[i];
+                    auto& e = expected[(size_t) i];
+
+                    for(auto error : { a.b0 - e.b0, a.b1 - e.b1, a.b2 - e.b2, a.a1 - e.a1, a.a2 - e.a2 })
+                        maxError = std::max(maxError, std::abs(error));
+                }
+            }
+
+            INFO("Sample rate " << sampleRate << ", slope " << s);
+            CHECK(maxError < 1.0e-5);
+        }
+    }
+}
+
+TEST_CASE("Instances share one table per sample rate", "[coefficientTable]") {
+    auto table = CrossoverCoefficientTable<float>::getShared(48000.0);
+
+    CHECK(table->getSampleRate() == 48000.0);
+    CHECK(CrossoverCoefficientTable<float>::getShared(48000.0) == table);
+    CHECK(CrossoverCoefficientTable<float>::getShared(44100.0) != table);
+
+    // The shared table is the same design as a private one
+    CrossoverCoefficientTable<float> own;
+    own.prepare(48000.0);
+
+    for(int s=0; s<numCrossoverSlopes; ++s)
+        for(float frequency = 20.0f; frequency <= 250.0f; frequency += 11.3f)
+        {
+            CrossoverCoefficientTable<float>::Section expected[CrossoverCoefficientTable<float>::maximumNumSections];
+            CrossoverCoefficientTable<float>::Section actual[CrossoverCoefficientTable<float>::maximumNumSections];
+            auto numSections = own.getHighPass((CrossoverSlope) s, frequency, expected);
+            REQUIRE(table->getHighPass((CrossoverSlope) s, frequency, actual) == numSections);
+
+            for(int i=0; i<numSections; ++i)
+            {
+                CHECK(actual[i].b0 == expected[i].b0);
+                CHECK(actual[i].a1 == expected[i].a1);
+                CHECK(actual[i].a2 == expected[i].a2);
+            }
+        }
+}
+
+TEST_CASE("Instances preparing at once get the same table", "[coefficientTable]") {
+    const int numThreads = 8;
+    std::vector<std::shared_ptr<const CrossoverCoefficientTable<double>>> tables(numThreads);
+    std::vector<std::thread> threads;
+
+    for(int i=0; i<numThreads; ++i)
+        threads.emplace_back([&tables, i] { tables[(size_t) i] = CrossoverCoefficientTable<double>::getShared(88200.0); });
+
+    for(auto& thread : threads)
+        thread.join();
+
+    for(auto& table : tables)
+    {
+        REQUIRE(table != nullptr);
+        CHECK(table == tables.front());
+    }
+}
@@ -0,0 +1,227 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+#include <complex>
+
+// Every slope must be a correctly designed crossover, and every kernel must run it exactly
+
+namespace
+{
+    using Section = MultichannelBiquadCascade<double>::Section;
+
+    std::complex<double> getResponse(const std::vector<Section>& sections, double frequency, double sampleRate)
+    {
+        auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+        std::complex<double> response(1.0);
+
+        for(auto& s : sections)
+            response *= (s.b0 + s.b1 * z + s.b2 * z * z) / (1.0 + s.a1 * z + s.a2 * z * z);
+
+        return response;
+    }
+
+    std::vector<Section> design(CrossoverSlope slope, bool isHighPass, double sampleRate, double frequency)
+    {
+        std::vector<Section> sections;
+        CrossoverCoefficientTable<double>::design(slope, isHighPass, sampleRate, frequency, sections);
+        return sections;
+    }
+
+    bool isLinkwitzRiley(CrossoverSlope slope)
+    {
+        return slope == CrossoverSlope::linkwitzRiley2 || slope == CrossoverSlope::linkwitzRiley4 || slope == CrossoverSlope::linkwitzRiley8;
+    }
+}
+
+TEST_CASE("Crossover slopes are matched pairs", "[crossoverSlope]") {
+    const double sampleRate = 48000.0;
+    const double crossover = 80.0;
+
+    for(int s=1; s<numCrossoverSlopes; ++s)
+    {
+        auto slope = (CrossoverSlope) s;
+        auto highPass = design(slope, true, sampleRate, crossover);
+        auto lowPass = design(slope, false, sampleRate, crossover);
+
+        CHECK((int) highPass.size() == CrossoverCoefficientTable<double>::getNumHighPassSections(slope));
+
+        // Linkwitz-Riley halves are -6 dB at the crossover and sum to an all-pass;
+        // Butterworth halves are -3 dB there and complementary in power
+        auto expectedAtCrossover = isLinkwitzRiley(slope) ? 0.5 : std::sqrt(0.5);
+        CHECK(std::abs(getResponse(highPass, crossover, sampleRate)) == Approx(expectedAtCrossover).margin(1.0e-6));
+        CHECK(std::abs(getResponse(lowPass, crossover, sampleRate)) == Approx(expectedAtCrossover).margin(1.0e-6));
+
+        for(double frequency = 10.0; frequency < 20000.0; frequency *= 1.3)
+        {
+            auto high = getResponse(highPass, frequency, sampleRate);
+            auto low = getResponse(lowPass, frequency, sampleRate);
+
+            if(isLinkwitzRiley(slope))
+                CHECK(std::abs(high + low) == Approx(1.0).margin(1.0e-6));
+            else
+                CHECK(std::norm(high) + std::norm(low) == Approx(1.0).margin(1.0e-6));
+        }
+    }
+}
+
+TEST_CASE("Coefficient table matches a fresh design for every slope", "[crossoverSlope]") {
+    CrossoverCoefficientTable<double> table;
+    table.prepare(96000.0);
+
+    for(int s=0; s<numCrossoverSlopes; ++s)
+    {
+        auto slope = (CrossoverSlope) s;
+
+        for(double frequency = 20.0; frequency <= 250.0; frequency += 7.3)
+        {
+            Section sections[CrossoverCoefficientTable<double>::maximumNumSections];
+            auto numSections = table.getHighPass(slope, frequency, sections);
+            auto expected = design(slope, true, 96000.0, frequency);
+
+            REQUIRE(numSections == (int) expected.size());
+
+            // Compared by response, since interpolated coefficients are only close to a fresh design
+            for(double probe : { frequency * 0.5, frequency, frequency * 2.0 })
+            {
+                auto actual = getResponse(std::vector<Section>(sections, sections + numSections), probe, 96000.0);
+                CHECK(std::abs(actual) == Approx(std::abs(getResponse(expected, probe, 96000.0))).margin(1.0e-3));
+            }
+        }
+    }
+}
+
+TEST_CASE("Fixed-length biquad kernels match a chain of IIR::Filter", "[crossoverSlope]") {
+    const double sampleRate = 48000.0;
+    const int numChannels = 3;
+    const int numSamples = 700;
+
+    auto highPass = juce::dsp::IIR::Coefficients<double>::makeHighPass(sampleRate, 80.0);
+    auto firstOrder = juce::dsp::IIR::Coefficients<double>::makeFirstOrderHighPass(sampleRate, 80.0);
+
+    // Up to eight sections have a kernel of their own, the rest share the generic one
+    MultichannelBiquadCascade<double> cascade;
+    cascade.prepare(numChannels, 10, 256);
+
+    for(int numSections=1; numSections<=10; ++numSections)
+    {
+        cascade.setNumSections(numSections);
+
+        for(int section=0; section<numSections; ++section)
+            cascade.setSection(section, section % 2 == 0 ? *highPass : *firstOrder);
+
+        juce::Random random(numSections);
+        juce::AudioBuffer<double> buffer(numChannels, numSamples), expected(numChannels, numSamples);
+
+        for(int ch=0; ch<numChannels; ++ch)
+            for(int i=0; i<numSamples; ++i)
+                buffer.setSample(ch, i, random.nextDouble() * 2.0 - 1.0);
+
+        expected.makeCopyOf(buffer);
+
+        for(int ch=0; ch<numChannels; ++ch)
+        {
+            std::vector<juce::dsp::IIR::Filter<double>> filters;
+
+            for(int section=0; section<numSections; ++section)
+                filters.emplace_back(section % 2 == 0 ? highPass : firstOrder);
+
+            for(int i=0; i<numSamples; ++i)
+            {
+                auto x = expected.getSample(ch, i);
+
+                for(auto& filter : filters)
+                    x = filter.processSample(x);
+
+                expected.setSample(ch, i, x);
+            }
+        }
+
+        cascade.process(buffer.getArrayOfWritePointers(), numSamples);
+
+        for(int ch=0; ch<numChannels; ++ch)
+            for(int i=0; i<numSamples; ++i)
+                CHECK(buffer.getSample(ch, i) == Approx(expected.getSample(ch, i)).margin(1.0e-9));
+    }
+}
+
+TEST_CASE("TPT low-pass cascade matches the biquad design of every slope", "[crossoverSlope]") {
+    const double sampleRate = 48000.0;
+    const int numSamples = 2000;
+
+    for(int s=0; s<numCrossoverSlopes; ++s)
+    {
+        auto slope = (CrossoverSlope) s;
+        auto prototype = CrossoverCoefficientTable<double>::getLowPassPrototype(slope);
+
+        TPTLowPassCascade<double> lowPass;
+        lowPass.prepare(sampleRate);
+        lowPass.setSections(prototype.numSecondOrder, prototype.dampings, prototype.numFirstOrder);
+        lowPass.setCutoffFrequency(90.0);
+
+        auto sections = design(slope, false, sampleRate, 90.0);
+        MultichannelBiquadCascade<double> expected;
+        expected.prepare(1, (int) sections.size(), numSamples);
+
+        for(int section=0; section<(int) sections.size(); ++section)
+            expected.setSection(section, sections[(size_t) section]);
+
+        juce::Random random(s);
+        std::vector<double> actualSamples((size_t) numSamples), expectedSamples;
+
+        for(auto& sample : actualSamples)
+            sample = random.nextDouble() * 2.0 - 1.0;
+
+        expectedSamples = actualSamples;
+        auto* expectedData = expectedSamples.data();
+
+        lowPass.process(actualSamples.data(), numSamples);
+        expected.process(&expectedData, numSamples);
+
+        for(int i=0; i<numSamples; ++i)
+            CHECK(actualSamples[(size_t) i] == Approx(expectedSamples[(size_t) i]).margin(1.0e-9));
+    }
+}
+
+TEST_CASE("Linkwitz-Riley slopes sum flat through the plugin", "[crossoverSlope]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    const double sampleRate = 48000.0;
+    const int blockSize = 480;
+    const int numSamples = 48000;
+    const float crossover = 80.0f;
+
+    for(int slope : { (int) CrossoverSlope::linkwitzRiley2, (int) CrossoverSlope::linkwitzRiley4, (int) CrossoverSlope::linkwitzRiley8 })
+    {
+        for(float frequency : { 40.0f, 80.0f, 160.0f })
+        {
+            BassicManagerAudioProcessor processor;
+            setParameter(processor, "crossoverSlope", (float) slope);
+            setParameter(processor, "crossoverFrequency", crossover);
+            setParameter(processor, "lfeLowPassFrequency", 250.0f);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            // The centre channel on its own: what the high-pass keeps plus what the
+            // bass sum sends to the LFE is the input, phase-shifted
+            juce::AudioBuffer<float> buffer(6, numSamples);
+            buffer.clear();
+
+            for(int i=0; i<numSamples; ++i)
+                buffer.setSample(BassicManagerAudioProcessor::C, i, 0.5f * (float)std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate));
+
+            processInBlocks(processor, buffer, blockSize);
+
+            double input = 0.0, output = 0.0;
+
+            for(int i=numSamples/2; i<numSamples; ++i)
+            {
+                auto x = 0.5 * std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate);
+                auto y = (double) buffer.getSample(BassicManagerAudioProcessor::C, i) + buffer.getSample(BassicManagerAudioProcessor::LFE, i);
+                input += x * x;
+                output += y * y;
+            }
+
+            CHECK(10.0 * std::log10(output / input) == Approx(0.0).margin(0.1));
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+// The double engine runs the same algorithms as the float one, so the two must
+// agree to within float rounding in every mode
+
+template <typename SampleType>
+static juce::AudioBuffer<SampleType> makeTestSignal(int numSamples, double sampleRate)
+{
+    juce::AudioBuffer<SampleType> buffer(6, numSamples);
+
+    for(int ch=0; ch<6; ++ch)
+    {
+        for(int i=0; i<numSamples; ++i)
+        {
+            auto t = (double)i / sampleRate;
+            auto value = 0.1 * (ch+1) * (std::sin(juce::MathConstants<double>::twoPi * 35.0 * t)
+                                         + 0.5 * std::sin(juce::MathConstants<double>::twoPi * 1500.0 * t));
+            buffer.setSample(ch, i, (SampleType)value);
+        }
+    }
+
+    return buffer;
+}
+
+template <typename SampleType>
+static void processInBlocksAnyPrecision(juce::AudioProcessor& processor, juce::AudioBuffer<SampleType>& buffer, int blockSize)
+{
+    juce::MidiBuffer midiBuffer;
+    juce::AudioBuffer<SampleType> blockBuffer;
+
+    for(int i=0; i<buffer.getNumSamples(); i+=blockSize)
+    {
+        auto subBlockSize = std::min(blockSize, buffer.getNumSamples()-i);
+        blockBuffer.setDataToReferTo(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), i, subBlockSize);
+        processor.processBlock(blockBuffer, midiBuffer);
+    }
+}
+
+TEST_CASE("The processor offers double precision", "[doublePrecision]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    BassicManagerAudioProcessor processor;
+
+    CHECK(processor.supportsDoublePrecisionProcessing());
+}
+
+TEST_CASE("Double-precision output matches single precision in every mode", "[doublePrecision]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    const int blockSize = 480;
+
+    for(auto sampleRate : { 48000.0, 192000.0 })
+    {
+        for(int topology : { 0, 1, 2 })
+        {
+            for(float multiRate : { 0.0f, 1.0f })
+            {
+                BassicManagerAudioProcessor single, dual;
+                dual.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+
+                for(auto* processor : { &single, &dual })
+                {
+                    setParameter(*processor, "crossoverTopology", (float)topology);
+                    setParameter(*processor, "multiRate", multiRate);
+                    setParameter(*processor, "crossoverFrequency", 25.0f);
+                    processor->prepareToPlay(sampleRate, blockSize);
+                }
+
+                CHECK(dual.getLatencySamples() == single.getLatencySamples());
+
+                auto numSamples = (int)(sampleRate / 2);
+                auto expected = makeTestSignal<float>(numSamples, sampleRate);
+                auto actual = makeTestSignal<double>(numSamples, sampleRate);
+
+                processInBlocksAnyPrecision(single, expected, blockSize);
+                processInBlocksAnyPrecision(dual, actual, blockSize);
+
+                for(int ch=0; ch<6; ++ch)
+                {
+                    double error = 0.0, signal = 0.0;
+
+                    for(int i=0; i<numSamples; ++i)
+                    {
+                        auto reference = (double)expected.getSample(ch, i);
+                        auto difference = actual.getSample(ch, i) - reference;
+                        error += difference * difference;
+                        signal += reference * reference;
+                    }
+
+                    CHECK(10.0 * std::log10(error / signal) < -70.0);
+                }
+            }
+        }
+    }
+}
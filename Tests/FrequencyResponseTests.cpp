@@ -0,0 +1,243 @@
+#include "catch2/catch.hpp"
+#include "ResponseVerification.h"
+
+// The measured responses sum, align and roll off as designed across a dense grid of settings
+
+namespace
+{
+    using namespace ResponseVerification;
+
+    const double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+    const int numGridFrequencies = 12;
+
+    // Log spaced across a parameter's range
+    float getGridFrequency(int index, float minimum, float maximum)
+    {
+        return minimum * std::pow(maximum / minimum, (float) index / (float) (numGridFrequencies - 1));
+    }
+
+    // The state-variable topology ignores the slope and always runs the classic alignment
+    CrossoverSlope getAlignment(const Setting& setting)
+    {
+        return setting.topology == CrossoverTopology::stateVariable ? CrossoverSlope::classic : setting.slope;
+    }
+
+    bool isLinkwitzRiley(CrossoverSlope slope)
+    {
+        return slope == CrossoverSlope::linkwitzRiley2 || slope == CrossoverSlope::linkwitzRiley4 || slope == CrossoverSlope::linkwitzRiley8;
+    }
+
+    // The multi-rate bass path runs its low-pass at a reduced rate, where the same
+    // design comes out slightly differently
+    double getLowPassRate(const Setting& setting)
+    {
+        return setting.multirate ? BassManagementEngine<double>::getMultirateSampleRate(setting.sampleRate) : setting.sampleRate;
+    }
+
+    // How far the measured roll-off between two frequencies is from the designed one, in dB per octave
+    double getSlopeError(const Response& response, const std::vector<std::complex<double>>& bins,
+                         CrossoverSlope slope, bool isHighPass, double sampleRate, double crossover, double a, double b)
+    {
+        auto binA = response.binFrequency(a), binB = response.binFrequency(b);
+        auto measured = toDecibels(Response::at(bins, response.binWidth, binA)) - toDecibels(Response::at(bins, response.binWidth, binB));
+        auto designed = toDecibels(getDesignedResponse(slope, isHighPass, sampleRate, crossover, binA))
+                      - toDecibels(getDesignedResponse(slope, isHighPass, sampleRate, crossover, binB));
+        return std::abs(measured - designed) / std::abs(std::log2(binA / binB));
+    }
+
+    struct CrossoverResult
+    {
+        double sumDeviation = 0.0, phaseError = 0.0, highPassSlopeError = 0.0, lowPassSlopeError = 0.0;
+    };
+
+    // The linear-phase bands are complementary by construction: the mains and the LFE
+    // sum back to a pure delay, and meet in phase wherever both carry signal
+    CrossoverResult verifyLinearPhaseCrossover(const Setting& setting, const Response& response)
+    {
+        CrossoverResult result;
+
+        for(double frequency = 10.0; frequency < setting.sampleRate * 0.45; frequency *= 1.1)
+        {
+            auto f = response.binFrequency(frequency);
+            result.sumDeviation = std::max(result.sumDeviation, std::abs(toDecibels(response.mainAt(f) + response.lfeAt(f))));
+        }
+
+        auto f = response.binFrequency(setting.crossoverFrequency);
+        result.phaseError = std::abs(getPhaseDifference(response.mainAt(f), response.lfeAt(f)));
+        return result;
+    }
+
+    // An impulse into the centre channel comes out high-passed there and low-passed in the LFE
+    CrossoverResult verifyCrossover(const Setting& setting)
+    {
+        auto response = measure(setting);
+
+        if(setting.topology == CrossoverTopology::linearPhase)
+            return verifyLinearPhaseCrossover(setting, response);
+
+        auto alignment = getAlignment(setting);
+        auto lowPassRate = getLowPassRate(setting);
+        double crossover = setting.crossoverFrequency;
+        CrossoverResult result;
+
+        // Linkwitz-Riley halves sum to an all-pass and Butterworth halves are power
+        // complementary; the classic alignment must sum the way it was designed. A
+        // multi-rate low-pass is designed at a lower rate than the high-pass, so those
+        // halves must sum the way both designs do, up to where the half-bands roll off
+        auto highestFrequency = setting.multirate ? BassManagementEngine<double>::multiratePassband : setting.sampleRate * 0.45;
+
+        for(double frequency = 10.0; frequency < highestFrequency; frequency *= 1.1)
+        {
+            auto f = response.binFrequency(frequency);
+            auto high = response.mainAt(f), low = response.lfeAt(f);
+            auto designedHigh = getDesignedResponse(alignment, true, setting.sampleRate, crossover, f);
+            auto designedLow = getDesignedResponse(alignment, false, lowPassRate, crossover, f);
+            double deviation;
+
+            if(alignment == CrossoverSlope::classic || (isLinkwitzRiley(alignment) && setting.multirate))
+                deviation = toDecibels(high + low) - toDecibels(designedHigh + designedLow);
+            else if(isLinkwitzRiley(alignment))
+                deviation = toDecibels(high + low);
+            else if(setting.multirate)
+                deviation = 10.0 * std::log10((std::norm(high) + std::norm(low)) / (std::norm(designedHigh) + std::norm(designedLow)));
+            else
+                deviation = 10.0 * std::log10(std::norm(high) + std::norm(low));
+
+            result.sumDeviation = std::max(result.sumDeviation, std::abs(deviation));
+        }
+
+        // The mains and the LFE meet at the crossover with the designed phase difference,
+        // so the mains' delay must match the multi-rate path's latency exactly
+        auto f = response.binFrequency(crossover);
+        auto measured = getPhaseDifference(response.mainAt(f), response.lfeAt(f));
+        auto designed = getPhaseDifference(getDesignedResponse(alignment, true, setting.sampleRate, crossover, f),
+                                           getDesignedResponse(alignment, false, lowPassRate, crossover, f));
+        result.phaseError = std::abs(std::remainder(measured - designed, 360.0));
+
+        // Half an octave under the crossover the steepest high-passes are already 25 dB down
+        result.highPassSlopeError = getSlopeError(response, response.main, alignment, true, setting.sampleRate, crossover,
+                                                  crossover, crossover * juce::MathConstants<double>::sqrt2 * 0.5);
+
+        // The half-bands' stopband leaves a floor near -74 dB that the steepest multi-rate
+        // low-passes reach within two octaves, so those are measured over the first
+        auto lowPassStart = setting.multirate ? crossover : crossover * 2.0;
+        result.lowPassSlopeError = getSlopeError(response, response.lfe, alignment, false, lowPassRate, crossover,
+                                                 lowPassStart, lowPassStart * 2.0);
+        return result;
+    }
+
+    struct LfeResult
+    {
+        double cutoffError = 0.0, passbandLevel = 0.0, slopeError = 0.0;
+    };
+
+    // An impulse into the LFE channel goes through its fourth order Linkwitz-Riley low-pass only
+    LfeResult verifyLfe(const Setting& setting)
+    {
+        auto response = measure(setting);
+        double cutoff = setting.lfeLowPassFrequency;
+        LfeResult result;
+
+        auto f = response.binFrequency(cutoff);
+        result.cutoffError = std::abs(toDecibels(response.lfeAt(f)) - toDecibels(getDesignedResponse(CrossoverSlope::linkwitzRiley4, false, setting.sampleRate, cutoff, f)));
+        result.passbandLevel = toDecibels(response.lfeAt(response.binFrequency(cutoff * 0.125)));
+        result.slopeError = getSlopeError(response, response.lfe, CrossoverSlope::linkwitzRiley4, false, setting.sampleRate, cutoff, cutoff * 2.0, cutoff * 4.0);
+        return result;
+    }
+}
+
+TEST_CASE("Every crossover alignment sums, aligns and rolls off as designed", "[frequencyResponse]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    std::vector<Setting> settings;
+
+    for(auto sampleRate : sampleRates)
+        for(int i=0; i<numGridFrequencies; ++i)
+            for(auto doublePrecision : { false, true })
+            {
+                Setting setting;
+                setting.doublePrecision = doublePrecision;
+                setting.sampleRate = sampleRate;
+                setting.crossoverFrequency = getGridFrequency(i, 20.0f, 250.0f);
+
+                // Every minimum-phase crossover, at the full rate and with the multi-rate bass path
+                for(auto multirate : { false, true })
+                {
+                    setting.multirate = multirate;
+                    setting.topology = CrossoverTopology::biquad;
+
+                    for(int s=0; s<numCrossoverSlopes; ++s)
+                    {
+                        setting.slope = (CrossoverSlope) s;
+                        settings.push_back(setting);
+                    }
+
+                    setting.topology = CrossoverTopology::stateVariable;
+                    setting.slope = CrossoverSlope::classic;
+                    settings.push_back(setting);
+                }
+
+                setting.multirate = false;
+                setting.topology = CrossoverTopology::linearPhase;
+                settings.push_back(setting);
+            }
+
+    auto results = forEachInParallel<CrossoverResult>(settings, verifyCrossover);
+
+    for(size_t i=0; i<settings.size(); ++i)
+    {
+        auto& setting = settings[i];
+        auto& result = results[i];
+
+        INFO("Sample rate " << setting.sampleRate << ", crossover " << setting.crossoverFrequency
+             << " Hz, topology " << (int) setting.topology << ", slope " << (int) setting.slope
+             << ", multi-rate " << setting.multirate << ", double precision " << setting.doublePrecision);
+
+        if(setting.topology == CrossoverTopology::linearPhase)
+        {
+            // Only the float convolutions' rounding separates the sum from a pure delay
+            CHECK(result.sumDeviation < 0.001);
+            CHECK(result.phaseError < 0.01);
+        }
+        else
+        {
+            CHECK(result.sumDeviation < 0.02);
+            CHECK(result.phaseError < 0.5);
+            CHECK(result.highPassSlopeError < 0.25);
+            CHECK(result.lowPassSlopeError < 0.25);
+        }
+    }
+}
+
+TEST_CASE("The LFE low-pass is a fourth order Linkwitz-Riley at every cutoff", "[frequencyResponse]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    std::vector<Setting> settings;
+
+    for(auto sampleRate : sampleRates)
+        for(int i=0; i<numGridFrequencies; ++i)
+            for(auto topology : { CrossoverTopology::biquad, CrossoverTopology::stateVariable })
+            {
+                Setting setting;
+                setting.sampleRate = sampleRate;
+                setting.lfeLowPassFrequency = getGridFrequency(i, 20.0f, 250.0f);
+                setting.topology = topology;
+                setting.inputChannel = BassicManagerAudioProcessor::LFE;
+                settings.push_back(setting);
+            }
+
+    auto results = forEachInParallel<LfeResult>(settings, verifyLfe);
+
+    for(size_t i=0; i<settings.size(); ++i)
+    {
+        auto& setting = settings[i];
+        auto& result = results[i];
+
+        INFO("Sample rate " << setting.sampleRate << ", LFE low-pass " << setting.lfeLowPassFrequency
+             << " Hz, topology " << (int) setting.topology);
+
+        CHECK(result.cutoffError < 0.05);
+        CHECK(result.passbandLevel == Approx(0.0).margin(0.05));
+        CHECK(result.slopeError < 0.25);
+    }
+}
@@ -0,0 +1,142 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+// The optional LFE limiter holds true peaks under its ceiling, and every channel waits for its look-ahead
+
+namespace
+{
+    // Runs a buffer through in lengths of 1 to 64 samples, so blocks end at every point of the lines
+    void processUnevenly(LookAheadLimiter<double>& limiter, juce::AudioBuffer<double>& buffer)
+    {
+        for(int start=0; start<buffer.getNumSamples();)
+        {
+            auto length = std::min(1 + (start * 7) % 64, buffer.getNumSamples() - start);
+            limiter.process(buffer.getArrayOfWritePointers(), start, length);
+            start += length;
+        }
+    }
+
+    float getPeak(const juce::AudioBuffer<float>& buffer, int channel, int startSample)
+    {
+        return buffer.getMagnitude(channel, startSample, buffer.getNumSamples() - startSample);
+    }
+}
+
+TEST_CASE("The limiter holds sample and inter-sample peaks under the ceiling", "[limiter]") {
+    const double sampleRate = 48000.0;
+    const int numSamples = 24000;
+    const double ceiling = juce::Decibels::decibelsToGain(-1.0);
+
+    LookAheadLimiter<double> limiter;
+    limiter.prepare(sampleRate, 2);
+    limiter.setCeiling(ceiling);
+
+    // A 50 Hz burst 12 dB over full scale that starts and stops abruptly, and a
+    // quarter-rate sine whose samples all miss its peaks by 3 dB
+    juce::AudioBuffer<double> buffer(2, numSamples);
+    buffer.clear();
+
+    for(int i=0; i<numSamples; ++i)
+    {
+        if(i >= 4000 && i < 12000)
+            buffer.setSample(0, i, 4.0 * std::sin(juce::MathConstants<double>::twoPi * 50.0 * i / sampleRate));
+
+        buffer.setSample(1, i, std::sin(juce::MathConstants<double>::halfPi * i + juce::MathConstants<double>::pi * 0.25));
+    }
+
+    processUnevenly(limiter, buffer);
+
+    CHECK(buffer.getMagnitude(0, 0, numSamples) <= ceiling * (1.0 + 1.0e-9));
+
+    // Once settled, the quarter-rate sine's true peak, sqrt (2) times its samples' peak, is at the ceiling
+    auto settled = limiter.getLatencyInSamples() + 2000;
+    auto truePeak = buffer.getMagnitude(1, settled, numSamples - settled) * std::sqrt(2.0);
+    CHECK(truePeak <= ceiling * 1.02);
+    CHECK(truePeak >= ceiling * 0.95);
+
+    // The burst is released once it's over
+    CHECK(buffer.getMagnitude(0, 12000 + limiter.getLatencyInSamples(), 100) < 1.0e-9);
+}
+
+TEST_CASE("The limiter passes quiet signals through delayed", "[limiter]") {
+    const int numSamples = 5000;
+
+    LookAheadLimiter<double> limiter;
+    limiter.prepare(44100.0, 1);
+    limiter.setCeiling(juce::Decibels::decibelsToGain(-1.0));
+
+    juce::AudioBuffer<double> buffer(1, numSamples), input(1, numSamples);
+
+    for(int i=0; i<numSamples; ++i)
+        input.setSample(0, i, 0.5 * std::sin(0.01 * i) + 0.2 * std::sin(0.13 * i));
+
+    buffer.makeCopyOf(input);
+    processUnevenly(limiter, buffer);
+
+    auto latency = limiter.getLatencyInSamples();
+    CHECK(latency > 0);
+
+    double maxError = 0.0;
+
+    for(int i=0; i<numSamples; ++i)
+        maxError = std::max(maxError, std::abs(buffer.getSample(0, i) - (i < latency ? 0.0 : input.getSample(0, i - latency))));
+
+    CHECK(maxError < 1.0e-12);
+}
+
+TEST_CASE("The LFE limiter reports its latency and keeps every channel aligned", "[limiter]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    const double sampleRate = 48000.0;
+    const int blockSize = 480;
+    const int numSamples = 9600;
+    const int numSubwoofers = 2;
+
+    // Returns the reported latency
+    auto process = [&](juce::AudioBuffer<float>& buffer, bool limit, float level)
+    {
+        BassicManagerAudioProcessor processor;
+        REQUIRE(processor.setBusesLayout(BassicManagerAudioProcessor::makeBusesLayout(juce::AudioChannelSet::create5point1(), numSubwoofers)));
+        setParameter(processor, "lfeLimiter", limit ? 1.0f : 0.0f);
+        setParameter(processor, "lfeBoost", 1.0f);
+        setParameter(processor, "subwooferGain2", 12.0f);
+        setParameter(processor, "channelDelay1", 2.0f);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        buffer.setSize(6 + numSubwoofers, numSamples);
+        buffer.clear();
+        juce::Random random(3);
+
+        for(int ch=0; ch<6; ++ch)
+            for(int i=0; i<numSamples; ++i)
+                buffer.setSample(ch, i, level * (random.nextFloat() - 0.5f));
+
+        processInBlocks(processor, buffer, blockSize);
+        return processor.getLatencySamples();
+    };
+
+    // Below the ceiling the limiter only delays, and every other channel by as much
+    juce::AudioBuffer<float> plain, limited, loud;
+    CHECK(process(plain, false, 0.01f) == 0);
+
+    auto latency = process(limited, true, 0.01f);
+    CHECK(latency == (int) std::round(sampleRate * LookAheadLimiter<float>::lookAheadSeconds) + 4);
+
+    float maxError = 0.0f;
+
+    for(int ch=0; ch<6 + numSubwoofers; ++ch)
+        for(int i=latency; i<numSamples; ++i)
+            maxError = std::max(maxError, std::abs(limited.getSample(ch, i) - plain.getSample(ch, i - latency)));
+
+    CHECK(maxError < 1.0e-6f);
+
+    // Loud enough that the boosted LFE and the +12 dB sub would clip, but the mains pass
+    process(loud, true, 2.0f);
+    auto ceiling = juce::Decibels::decibelsToGain(-1.0f);
+
+    CHECK(getPeak(loud, BassicManagerAudioProcessor::LFE, 0) <= ceiling * 1.0001f);
+    CHECK(getPeak(loud, 6, 0) <= ceiling * 1.0001f);
+    CHECK(getPeak(loud, 7, 0) <= ceiling * 1.0001f);
+    CHECK(getPeak(loud, BassicManagerAudioProcessor::C, 0) > ceiling);
+}
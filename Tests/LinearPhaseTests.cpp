@@ -0,0 +1,177 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+#include <thread>
+
+TEST_CASE("Partitioned convolution matches direct convolution", "[linearPhase]") {
+    juce::Random random(3);
+
+    int impulseLength = 1000;
+    int lengthInSamples = 6000;
+    int numChannels = 3;
+
+    std::vector<float> impulse((size_t)impulseLength);
+
+    for(auto& tap : impulse)
+        tap = random.nextFloat() * 2.0f - 1.0f;
+
+    juce::AudioBuffer<float> input(numChannels, lengthInSamples);
+
+    for(int ch=0; ch<numChannels; ++ch)
+        for(int i=0; i<lengthInSamples; ++i)
+            input.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+    PartitionedConvolution convolution;
+    convolution.prepare(numChannels, impulseLength);
+
+    for(int partitionSize = PartitionedConvolution::minimumPartitionSize; partitionSize <= PartitionedConvolution::maximumPartitionSize; partitionSize *= 2)
+    {
+        convolution.setPartitionSize(partitionSize);
+        convolution.setImpulseResponse(impulse.data(), impulseLength);
+        REQUIRE(convolution.getLatencyInSamples() == partitionSize);
+
+        juce::AudioBuffer<float> output;
+        output.makeCopyOf(input);
+
+        // Block sizes that don't line up with the partitions
+        for(int start=0, blockSize=1; start<lengthInSamples; start+=blockSize, blockSize=blockSize % 300 + 77)
+        {
+            auto num = juce::jmin(blockSize, lengthInSamples - start);
+            float* channels[3];
+
+            for(int ch=0; ch<numChannels; ++ch)
+                channels[ch] = output.getWritePointer(ch, start);
+
+            convolution.process(channels, num);
+        }
+
+        for(int ch=0; ch<numChannels; ++ch)
+        {
+            float maxError = 0.0f;
+
+            for(int i=partitionSize; i<lengthInSamples; ++i)
+            {
+                double expected = 0.0;
+                auto n = i - partitionSize;
+
+                for(int k=0; k<impulseLength && k<=n; ++k)
+                    expected += impulse[(size_t)k] * input.getSample(ch, n - k);
+
+                maxError = juce::jmax(maxError, (float)std::abs(output.getSample(ch, i) - expected));
+            }
+
+            CHECK(maxError < 1.0e-3f);
+        }
+    }
+}
+
+TEST_CASE("A new impulse response fades in over one partition", "[linearPhase]") {
+    juce::Random random(5);
+
+    int impulseLength = 700;
+    int partitionSize = 128;
+    int lengthInSamples = 12 * partitionSize;
+    int switchPartition = 5;
+
+    std::vector<float> oldImpulse((size_t)impulseLength), newImpulse((size_t)impulseLength);
+
+    for(size_t k=0; k<oldImpulse.size(); ++k)
+    {
+        oldImpulse[k] = random.nextFloat() * 2.0f - 1.0f;
+        newImpulse[k] = random.nextFloat() * 2.0f - 1.0f;
+    }
+
+    std::vector<float> input((size_t)lengthInSamples);
+
+    for(auto& sample : input)
+        sample = random.nextFloat() * 2.0f - 1.0f;
+
+    PartitionedConvolution convolution;
+    convolution.prepare(1, impulseLength);
+    convolution.setPartitionSize(partitionSize);
+    convolution.setImpulseResponse(oldImpulse.data(), impulseLength);
+
+    auto output = input;
+
+    for(int partition=0; partition<lengthInSamples / partitionSize; ++partition)
+    {
+        // Handed over from another thread, as the message thread does
+        if(partition == switchPartition)
+        {
+            std::thread([&] { convolution.setNextImpulseResponse(newImpulse.data(), impulseLength); }).join();
+            CHECK(convolution.hasNextImpulseResponse());
+        }
+
+        float* channel = output.data() + partition * partitionSize;
+        convolution.process(&channel, partitionSize);
+    }
+
+    CHECK(! convolution.hasNextImpulseResponse());
+
+    auto convolve = [&](const std::vector<float>& impulse, int n)
+    {
+        double sum = 0.0;
+
+        for(int k=0; k<impulseLength && k<=n; ++k)
+            sum += impulse[(size_t)k] * input[(size_t)(n - k)];
+
+        return sum;
+    };
+
+    // The partition computed after the handover comes out one partition later
+    auto fadeStart = (switchPartition + 1) * partitionSize;
+    float maxError = 0.0f;
+
+    for(int i=partitionSize; i<lengthInSamples; ++i)
+    {
+        auto before = convolve(oldImpulse, i - partitionSize);
+        auto after = convolve(newImpulse, i - partitionSize);
+        auto fade = juce::jlimit(0.0, 1.0, (i - fadeStart + 1) / (double)partitionSize);
+        auto expected = before + (after - before) * fade;
+        maxError = juce::jmax(maxError, (float)std::abs(output[(size_t)i] - expected));
+    }
+
+    CHECK(maxError < 1.0e-3f);
+}
+
+TEST_CASE("Linear-phase bands sum back to a delayed input", "[linearPhase]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    double sampleRate = 48000.0;
+    int blockSize = 512;
+
+    for(auto partition : { 0.0f, 2.0f, 4.0f })
+    {
+        BassicManagerAudioProcessor processor;
+        setParameter(processor, "crossoverTopology", 2.0f);
+        setParameter(processor, "linearPhasePartition", partition);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        auto partitionSize = PartitionedConvolution::minimumPartitionSize << (int)partition;
+        auto latency = processor.getLatencySamples();
+        CHECK(latency == juce::roundToInt(sampleRate * LinearPhaseCrossover<float>::lengthSeconds) / 2 + partitionSize);
+
+        // An impulse on the left channel: its high band plus the bass in the LFE is the impulse again
+        int lengthInSamples = latency + 2 * blockSize;
+        juce::AudioBuffer<float> buffer(6, lengthInSamples);
+        buffer.clear();
+        buffer.setSample(BassicManagerAudioProcessor::L, 0, 1.0f);
+
+        processInBlocks(processor, buffer, blockSize);
+
+        float maxError = 0.0f;
+
+        for(int i=0; i<lengthInSamples; ++i)
+        {
+            auto expected = i == latency ? 1.0f : 0.0f;
+            auto actual = buffer.getSample(BassicManagerAudioProcessor::L, i) + buffer.getSample(BassicManagerAudioProcessor::LFE, i);
+            maxError = juce::jmax(maxError, std::abs(actual - expected));
+        }
+
+        CHECK(maxError < 1.0e-4f);
+
+        // The other mains stay silent
+        CHECK(buffer.getMagnitude(BassicManagerAudioProcessor::R, 0, lengthInSamples) == 0.0f);
+    }
+}
@@ -0,0 +1,109 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+namespace
+{
+    // Fills one channel of a 5.1 buffer with a sine and leaves the rest silent
+    juce::AudioBuffer<float> makeSine(int channel, float frequency, float amplitude, double sampleRate, int numSamples)
+    {
+        juce::AudioBuffer<float> buffer(6, numSamples);
+        buffer.clear();
+
+        for(int i=0; i<numSamples; ++i)
+            buffer.setSample(channel, i, amplitude * std::sin(juce::MathConstants<float>::twoPi * frequency * (float) i / (float) sampleRate));
+
+        return buffer;
+    }
+}
+
+TEST_CASE("Nothing is metered without an editor", "[metering]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    BassicManagerAudioProcessor processor;
+    processor.prepareToPlay(48000.0, 512);
+
+    auto buffer = makeSine(BassicManagerAudioProcessor::L, 1000.0f, 0.5f, 48000.0, 4096);
+    processInBlocks(processor, buffer, 512);
+
+    MeterSource::Summary summary;
+    CHECK(processor.getMeterSource().readSummaries(summary) == 0);
+
+    float lfe[64], mains[64];
+    CHECK(processor.getMeterSource().readSpectrumSamples(lfe, mains, 64) == 0);
+}
+
+// A prepared 5.1 processor with its editor open
+struct MeteredSession
+{
+    MeteredSession()
+    {
+        processor.prepareToPlay(48000.0, 512);
+        processor.getMeterSource().setActive(true);
+    }
+
+    MeterSource::Summary process(juce::AudioBuffer<float>& buffer, int blockSize)
+    {
+        processInBlocks(processor, buffer, blockSize);
+
+        MeterSource::Summary summary;
+        processor.getMeterSource().readSummaries(summary);
+        return summary;
+    }
+
+    juce::ScopedJuceInitialiser_GUI gui;
+    BassicManagerAudioProcessor processor;
+};
+
+TEST_CASE("A sine well above the crossover is metered on its main", "[metering]") {
+    MeteredSession session;
+
+    // A whole number of cycles, so the second pass continues the first after its onset transient
+    auto buffer = makeSine(BassicManagerAudioProcessor::L, 750.0f, 0.5f, 48000.0, 8192);
+    auto onset = buffer;
+    session.process(onset, 512);
+    auto summary = session.process(buffer, 512);
+
+    CHECK(summary.numSamples == 8192);
+    CHECK(summary.peak[BassicManagerAudioProcessor::L] == Approx(0.5f).margin(0.02f));
+    CHECK(summary.getRMS(BassicManagerAudioProcessor::L) == Approx(0.5f / std::sqrt(2.0f)).margin(0.02f));
+    CHECK(summary.peak[BassicManagerAudioProcessor::R] == 0.0f);
+    CHECK(summary.getBassRMS() < 0.01f);
+}
+
+TEST_CASE("A sine well below the crossover is metered as redirected bass", "[metering]") {
+    MeteredSession session;
+    auto buffer = makeSine(BassicManagerAudioProcessor::L, 25.0f, 0.5f, 48000.0, 48000);
+    auto summary = session.process(buffer, 512);
+
+    CHECK(summary.getBassRMS() > 0.25f);
+    CHECK(summary.getRMS(BassicManagerAudioProcessor::LFE) > 0.25f);
+    CHECK(summary.getRMS(BassicManagerAudioProcessor::L) < 0.1f);
+}
+
+TEST_CASE("The analyser gets every output sample of the LFE and the summed mains", "[metering]") {
+    MeteredSession session;
+    auto buffer = makeSine(BassicManagerAudioProcessor::C, 1000.0f, 0.5f, 48000.0, 2000);
+    session.process(buffer, 100);
+
+    std::vector<float> lfe(4096), mains(4096);
+    REQUIRE(session.processor.getMeterSource().readSpectrumSamples(lfe.data(), mains.data(), 4096) == 2000);
+
+    for(int i=0; i<2000; ++i)
+    {
+        CHECK(mains[(size_t) i] == buffer.getSample(BassicManagerAudioProcessor::C, i));
+        CHECK(lfe[(size_t) i] == buffer.getSample(BassicManagerAudioProcessor::LFE, i));
+    }
+}
+
+TEST_CASE("The meter FIFOs drop rather than block when the reader stalls", "[metering]") {
+    MeterSource meterSource;
+    meterSource.prepare(6, 48000.0);
+    meterSource.setActive(true);
+
+    for(int i=0; i<MeterSource::summaryFifoSize * 2; ++i)
+        meterSource.finishBlock();
+
+    MeterSource::Summary summary;
+    CHECK(meterSource.readSummaries(summary) < MeterSource::summaryFifoSize);
+    CHECK(meterSource.readSummaries(summary) == 0);
+}
@@ -0,0 +1,55 @@
+#include "catch2/catch.hpp"
+#include <MultichannelBiquad.h>
+
+// The SIMD cascade must match a chain of plain IIR::Filter objects run channel by channel
+
+TEST_CASE("Multichannel biquad matches IIR::Filter", "[multichannelBiquad]") {
+    const double sampleRate = 48000.0;
+    const int numChannels = 5;
+    const int numSamples = 1000;
+    const int maxBlockSize = 256;
+
+    auto highPass = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, 80.0f);
+    auto firstOrder = juce::dsp::IIR::Coefficients<float>::makeFirstOrderHighPass(sampleRate, 80.0f);
+
+    MultichannelBiquadCascade<float> cascade;
+    cascade.prepare(numChannels, 3, maxBlockSize);
+    cascade.setSection(0, *highPass);
+    cascade.setSection(1, *firstOrder);
+    cascade.setSection(2, *highPass);
+
+    juce::Random random;
+    juce::AudioBuffer<float> buffer(numChannels, numSamples);
+
+    for(int ch=0; ch<numChannels; ++ch)
+        for(int i=0; i<numSamples; ++i)
+            buffer.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+    juce::AudioBuffer<float> expected;
+    expected.makeCopyOf(buffer);
+
+    for(int ch=0; ch<numChannels; ++ch)
+    {
+        juce::dsp::IIR::Filter<float> a(highPass), b(firstOrder), c(highPass);
+        auto samples = expected.getWritePointer(ch);
+
+        for(int i=0; i<numSamples; ++i)
+            samples[i] = c.processSample(b.processSample(a.processSample(samples[i])));
+    }
+
+    // Odd block sizes, including one larger than the prepared maximum
+    for(int start=0, blockSize=1; start<numSamples; start+=blockSize, blockSize=blockSize*3+1)
+    {
+        auto num = std::min(blockSize, numSamples-start);
+        float* channels[numChannels];
+
+        for(int ch=0; ch<numChannels; ++ch)
+            channels[ch] = buffer.getWritePointer(ch, start);
+
+        cascade.process(channels, num);
+    }
+
+    for(int ch=0; ch<numChannels; ++ch)
+        for(int i=0; i<numSamples; ++i)
+            CHECK(buffer.getSample(ch, i) == Approx(expected.getSample(ch, i)).margin(1.0e-5));
+}
@@ -0,0 +1,67 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+// Fills every channel with a bass tone plus a tone well above the crossover
+static void fillTestSignal(juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    for(int ch=0; ch<buffer.getNumChannels(); ++ch)
+    {
+        auto samples = buffer.getWritePointer(ch);
+        auto gain = 0.1f * (float)(ch+1);
+
+        for(int i=0; i<buffer.getNumSamples(); ++i)
+        {
+            auto t = (double)i / sampleRate;
+            samples[i] = gain * (float)(std::sin(juce::MathConstants<double>::twoPi * 40.0 * t)
+                                        + 0.5 * std::sin(juce::MathConstants<double>::twoPi * 2000.0 * t));
+        }
+    }
+}
+
+TEST_CASE("Multi-rate bass path matches the full-rate path", "[multiRate]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    for(auto sampleRate : { 48000.0, 96000.0, 192000.0 })
+    {
+        int blockSize = 500;
+        int lengthInSamples = (int)sampleRate;
+
+        BassicManagerAudioProcessor fullRate, multiRate;
+        setParameter(multiRate, "multiRate", 1.0f);
+
+        fullRate.prepareToPlay(sampleRate, blockSize);
+        multiRate.prepareToPlay(sampleRate, blockSize);
+
+        auto latency = multiRate.getLatencySamples();
+        CHECK(fullRate.getLatencySamples() == 0);
+        REQUIRE(latency > 0);
+
+        juce::AudioBuffer<float> expected(6, lengthInSamples), actual(6, lengthInSamples);
+        fillTestSignal(expected, sampleRate);
+        fillTestSignal(actual, sampleRate);
+
+        processInBlocks(fullRate, expected, blockSize);
+        processInBlocks(multiRate, actual, blockSize);
+
+        // Once settled, the multi-rate output is the full-rate output delayed by the reported latency
+        auto start = lengthInSamples / 2;
+        auto num = lengthInSamples - start - latency;
+
+        for(int ch=0; ch<6; ++ch)
+        {
+            double error = 0.0, signal = 0.0;
+
+            for(int i=start; i<start+num; ++i)
+            {
+                auto reference = expected.getSample(ch, i);
+                auto difference = actual.getSample(ch, i+latency) - reference;
+                error += difference * difference;
+                signal += reference * reference;
+            }
+
+            auto errorDecibels = 10.0 * std::log10(error / signal);
+            CHECK(errorDecibels < -40.0);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+// Spreading the channel groups over worker threads changes nothing but the time it takes
+
+namespace
+{
+    const double sampleRate = 48000.0;
+    const int numSamples = 48000;
+    const int numSubwoofers = 2;
+
+    // Long blocks go to the workers in one or more handoffs, short ones fall back to the tiles
+    const int blockSizes[] = { 4500, 1024, 100, 300, 2048, 37, 256, 255 };
+
+    // Noise with some mains silent for the first half and everything silent for a stretch in
+    // the middle, in uneven blocks, with the crossover moved halfway through
+    void render(juce::AudioBuffer<float>& buffer, const juce::AudioChannelSet& layout, bool parallel,
+                CrossoverTopology topology, bool multirate)
+    {
+        BassicManagerAudioProcessor processor;
+        REQUIRE(processor.setBusesLayout(BassicManagerAudioProcessor::makeBusesLayout(layout, numSubwoofers)));
+        setParameter(processor, "parallelChannels", parallel ? 1.0f : 0.0f);
+        setParameter(processor, "crossoverTopology", (float) topology);
+        setParameter(processor, "multiRate", multirate ? 1.0f : 0.0f);
+        setParameter(processor, "lfeLimiter", 1.0f);
+        setParameter(processor, "channelDelay3", 1.5f);
+        setParameter(processor, "subwooferDelay2", 2.0f);
+        processor.prepareToPlay(sampleRate, 4096);
+
+        if(parallel)
+            REQUIRE(processor.getNumChannelGroupWorkers() > 0);
+
+        buffer.setSize(layout.size() + numSubwoofers, numSamples);
+        buffer.clear();
+        juce::Random random(5);
+
+        for(int ch=0; ch<layout.size(); ++ch)
+            for(int i=0; i<numSamples; ++i)
+                if((ch % 3 != 1 || i >= numSamples / 2) && (i < 20000 || i >= 30000))
+                    buffer.setSample(ch, i, random.nextFloat() - 0.5f);
+
+        juce::MidiBuffer midiBuffer;
+        juce::AudioBuffer<float> block;
+        auto moved = false;
+
+        for(int start=0, b=0; start<numSamples; ++b)
+        {
+            if(! moved && start >= numSamples / 2)
+            {
+                setParameter(processor, "crossoverFrequency", 110.0f);
+                moved = true;
+            }
+
+            auto length = std::min(blockSizes[b % std::size(blockSizes)], numSamples - start);
+            block.setDataToReferTo(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, length);
+            processor.processBlock(block, midiBuffer);
+            start += length;
+        }
+    }
+}
+
+TEST_CASE("Parallel channel groups give exactly the serial output", "[parallel]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    auto cores = ScopedMinimumNumCores(4);
+
+    for(auto& layout : { juce::AudioChannelSet::create5point1(), juce::AudioChannelSet::create7point1point4(), juce::AudioChannelSet::create9point1point6() })
+        for(auto topology : { CrossoverTopology::biquad, CrossoverTopology::stateVariable })
+            for(auto multirate : { false, true })
+            {
+                INFO(layout.getDescription() << ", topology " << (int) topology << ", multi-rate " << multirate);
+
+                juce::AudioBuffer<float> serial, parallel;
+                render(serial, layout, false, topology, multirate);
+                render(parallel, layout, true, topology, multirate);
+
+                for(int ch=0; ch<serial.getNumChannels(); ++ch)
+                {
+                    auto difference = 0.0f;
+
+                    for(int i=0; i<numSamples; ++i)
+                        difference = std::max(difference, std::abs(parallel.getSample(ch, i) - serial.getSample(ch, i)));
+
+                    CHECK(difference == 0.0f);
+                }
+            }
+}
@@ -0,0 +1,63 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+// The audio thread sees parameters through a snapshot that says what changed
+
+TEST_CASE("The parameter snapshot only marks fields that changed", "[parameters]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    BassicManagerAudioProcessor processor;
+    ParameterSnapshot snapshot(processor.getValueTreeState());
+
+    CHECK(snapshot.update().changed == BassManagementParameters::allFields);
+    CHECK(snapshot.update().changed == 0);
+
+    setParameter(processor, "crossoverFrequency", 80.0f);
+    auto& values = snapshot.update();
+    CHECK(values.changed == BassManagementParameters::crossoverFrequencyField);
+    CHECK(values.crossoverFrequency == Approx(80.0f));
+    CHECK(snapshot.update().changed == 0);
+
+    setParameter(processor, "lfeBoost", 1.0f);
+    setParameter(processor, "linearPhasePartition", 3.0f);
+    CHECK(snapshot.update().changed == (BassManagementParameters::lfeBoostField | BassManagementParameters::linearPhasePartitionSizeField));
+    CHECK(snapshot.update().lfeBoost);
+    CHECK(snapshot.update().linearPhasePartitionSize == 512);
+}
+
+TEST_CASE("LFE boost raises the LFE channel by 10 dB", "[parameters]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+    const int numSamples = 48000;
+
+    for(float multiRate : { 0.0f, 1.0f })
+    {
+        double rms[2] = {};
+
+        for(int boost : { 0, 1 })
+        {
+            BassicManagerAudioProcessor processor;
+            setParameter(processor, "multiRate", multiRate);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            // Switched on mid-stream, so the change has to reach an engine that is already running
+            juce::AudioBuffer<float> silence(6, blockSize);
+            silence.clear();
+            processInBlocks(processor, silence, blockSize);
+            setParameter(processor, "lfeBoost", (float)boost);
+
+            juce::AudioBuffer<float> buffer(6, numSamples);
+            buffer.clear();
+
+            for(int i=0; i<numSamples; ++i)
+                buffer.setSample(BassicManagerAudioProcessor::LFE, i, 0.1f * (float)std::sin(juce::MathConstants<double>::twoPi * 30.0 * i / sampleRate));
+
+            processInBlocks(processor, buffer, blockSize);
+            rms[boost] = buffer.getRMSLevel(BassicManagerAudioProcessor::LFE, numSamples / 2, numSamples / 2);
+        }
+
+        CHECK(juce::Decibels::gainToDecibels(rms[1] / rms[0]) == Approx(10.0).margin(0.01));
+    }
+}
@@ -0,0 +1,155 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+#include <cstdlib>
+
+namespace
+{
+    // Keeps a noisy 5.1 session going so every stage has work to do
+    struct ProfiledSession
+    {
+        ProfiledSession()
+            : buffer(6, 512)
+        {
+            setParameter(processor, "channelDelay3", 1.5f);
+            processor.prepareToPlay(48000.0, 512);
+
+            juce::Random random(3);
+
+            for(int ch=0; ch<buffer.getNumChannels(); ++ch)
+                for(int i=0; i<buffer.getNumSamples(); ++i)
+                    buffer.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+        }
+
+        void process(int numBlocks)
+        {
+            for(int i=0; i<numBlocks; ++i)
+            {
+                setParameter(processor, "crossoverFrequency", 40.0f + (float)(i % 100));
+                processor.processBlock(buffer, midi);
+            }
+        }
+
+        juce::ScopedJuceInitialiser_GUI gui;
+        BassicManagerAudioProcessor processor;
+        juce::AudioBuffer<float> buffer;
+        juce::MidiBuffer midi;
+    };
+
+    int countOccurrences(const juce::String& text, const juce::String& pattern)
+    {
+        int count = 0;
+
+        for(auto index = text.indexOf(pattern); index >= 0; index = text.indexOf(index + 1, pattern))
+            ++count;
+
+        return count;
+    }
+}
+
+TEST_CASE("Histogram bins cover a quarter octave each", "[profiling]") {
+    CHECK(ProcessingProfiler::getBinForNanoseconds(10.0) == 0);
+    CHECK(ProcessingProfiler::getBinForNanoseconds(128.0) == ProcessingProfiler::binsPerOctave);
+    CHECK(ProcessingProfiler::getBinForNanoseconds(1.0e12) == ProcessingProfiler::numHistogramBins - 1);
+
+    for(int bin=0; bin<ProcessingProfiler::numHistogramBins - 1; ++bin)
+        CHECK(ProcessingProfiler::getBinForNanoseconds(ProcessingProfiler::getBinUpperEdgeNanoseconds(bin) * 0.99) == bin);
+}
+
+TEST_CASE("Every block is timed, stages only on request", "[profiling]") {
+    ProfiledSession session;
+    auto& profiler = session.processor.getProfiler();
+
+    session.process(50);
+
+    auto snapshot = profiler.getSnapshot();
+    CHECK(snapshot.blocks == 50);
+    CHECK(snapshot.averageLoad > 0.0);
+    CHECK(snapshot.stages[ProcessingProfiler::bassSum].count == 0);
+
+    profiler.setStageTimingEnabled(true);
+    session.process(50);
+
+    snapshot = profiler.getSnapshot();
+    CHECK(snapshot.blocks == 100);
+
+    for(int stage=0; stage<ProcessingProfiler::wholeBlock; ++stage)
+    {
+        CHECK(snapshot.stages[(size_t) stage].count == 50);
+        CHECK(snapshot.stages[(size_t) stage].totalNanoseconds > 0.0);
+        CHECK(snapshot.stages[(size_t) stage].maximumNanoseconds <= snapshot.stages[ProcessingProfiler::wholeBlock].maximumNanoseconds);
+    }
+
+    juce::uint32 histogramTotal = 0;
+
+    for(auto count : snapshot.stages[ProcessingProfiler::wholeBlock].histogram)
+        histogramTotal += count;
+
+    CHECK(histogramTotal == 100);
+}
+
+TEST_CASE("A missed deadline is blamed on the slowest stage", "[profiling]") {
+    ProcessingProfiler profiler;
+
+    // One sample at 1 GHz leaves a 1 ns budget, which any stage will blow
+    profiler.prepare(1.0e9);
+    profiler.setStageTimingEnabled(true);
+
+    {
+        ProcessingProfiler::ScopedBlock block(profiler, 1);
+        ProcessingProfiler::ScopedStage stage(profiler, ProcessingProfiler::coefficientUpdate);
+
+        auto until = juce::Time::getHighResolutionTicks() + juce::Time::getHighResolutionTicksPerSecond() / 1000;
+
+        while(juce::Time::getHighResolutionTicks() < until) {}
+    }
+
+    auto snapshot = profiler.getSnapshot();
+    CHECK(snapshot.overruns == 1);
+    CHECK(snapshot.overrunsByStage[ProcessingProfiler::coefficientUpdate] == 1);
+    CHECK(snapshot.stages[ProcessingProfiler::coefficientUpdate].maximumNanoseconds >= 1.0e6);
+}
+
+TEST_CASE("Traces are written in the Chrome trace-event format", "[profiling]") {
+    ProfiledSession session;
+    auto& profiler = session.processor.getProfiler();
+    profiler.setTraceEnabled(true);
+
+    session.process(20);
+
+    std::vector<ProcessingProfiler::Event> events(4096);
+    auto numEvents = profiler.readEvents(events.data(), (int) events.size());
+
+    // 512 samples is eight tiles of four stages each plus a cutoff step each, as the
+    // crossover glides all the time, then the mode and target update and the block itself
+    CHECK(numEvents == 20 * (8 * (4 + 1) + 1 + 1));
+
+    for(int i=0; i<numEvents; ++i)
+        CHECK(events[(size_t) i].endTicks >= events[(size_t) i].startTicks);
+
+    juce::MemoryOutputStream stream;
+
+    {
+        ChromeTraceWriter trace(stream);
+        trace.addThreadName(1, "Audio");
+        trace.addEvents(events.data(), numEvents, 1);
+    }
+
+    auto json = stream.toString();
+    CHECK(json.startsWith("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["));
+    CHECK(json.trim().endsWith("]}"));
+    CHECK(countOccurrences(json, "\"ph\":\"X\"") == numEvents);
+    CHECK(countOccurrences(json, "\"name\":\"bassSum\"") == 20 * 8);
+
+    // Set BASSICMANAGER_TRACE to keep the trace for chrome://tracing or Perfetto
+    if(auto* path = std::getenv("BASSICMANAGER_TRACE"))
+    {
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile(path);
+        file.deleteFile();
+
+        juce::FileOutputStream output(file);
+        REQUIRE(output.openedOk());
+        output << json;
+    }
+}
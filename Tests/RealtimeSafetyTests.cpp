@@ -0,0 +1,250 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+#include <mutex>
+
+// Everything processBlock does while the auditor counts. Parameters are set
+// between blocks, as a host's message thread would, and a listener is attached
+// as a host's wrapper would, since notifying it takes the processor's lock
+struct AuditedSession : private juce::AudioProcessorListener
+{
+    AuditedSession(const juce::AudioChannelSet& layout = juce::AudioChannelSet::create5point1(),
+                   double sampleRate = 48000.0, int preparedBlockSize = 512, int numSubwoofers = 0)
+        : buffer(layout.size() + numSubwoofers, 4096)
+    {
+        REQUIRE(processor.setBusesLayout(BassicManagerAudioProcessor::makeBusesLayout(layout, numSubwoofers)));
+
+        processor.addListener(this);
+        processor.prepareToPlay(sampleRate, preparedBlockSize);
+
+        juce::Random random(11);
+
+        for(int ch=0; ch<buffer.getNumChannels(); ++ch)
+            for(int i=0; i<buffer.getNumSamples(); ++i)
+                buffer.setSample(ch, i, random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    void process(int numSamples)
+    {
+        block.setDataToReferTo(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), 0, numSamples);
+
+        RealtimeAudit::resetCounts();
+        processor.processBlock(block, midi);
+        auto counts = RealtimeAudit::getCounts();
+
+        CHECK(counts.allocations == 0);
+        CHECK(counts.deallocations == 0);
+        CHECK(counts.lockAcquisitions == 0);
+    }
+
+    ~AuditedSession() override
+    {
+        processor.removeListener(this);
+    }
+
+    void audioProcessorParameterChanged(juce::AudioProcessor*, int, float) override {}
+    void audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails&) override {}
+
+    BassicManagerAudioProcessor processor;
+    juce::AudioBuffer<float> buffer, block;
+    juce::MidiBuffer midi;
+};
+
+TEST_CASE("The auditor sees allocations and locks in a callback", "[realtime]") {
+    RealtimeAudit::resetCounts();
+
+    {
+        RealtimeAudit::ScopedAudioCallback callback;
+        std::vector<float> allocating(64);
+        juce::ignoreUnused(allocating);
+    }
+
+    auto counts = RealtimeAudit::getCounts();
+    CHECK(counts.allocations >= 1);
+    CHECK(counts.deallocations >= 1);
+
+   #if defined(__linux__)
+    std::mutex mutex;
+    RealtimeAudit::resetCounts();
+
+    {
+        RealtimeAudit::ScopedAudioCallback callback;
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+
+    CHECK(RealtimeAudit::getCounts().lockAcquisitions >= 1);
+   #endif
+
+    // Nothing counts outside a callback
+    RealtimeAudit::resetCounts();
+    std::vector<float> notCounted(64);
+    CHECK(RealtimeAudit::getCounts().isClean());
+}
+
+TEST_CASE("processBlock doesn't allocate or lock under automation", "[realtime]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    for(auto topology : { 0.0f, 1.0f, 2.0f })
+    {
+        for(auto multiRate : { 0.0f, 1.0f })
+        {
+            AuditedSession session;
+            setParameter(session.processor, "crossoverTopology", topology);
+            setParameter(session.processor, "multiRate", multiRate);
+
+            for(int i=0; i<64; ++i)
+            {
+                setParameter(session.processor, "crossoverFrequency", 20.0f + 3.5f * i);
+                setParameter(session.processor, "lfeLowPassFrequency", 250.0f - 3.5f * i);
+                session.process(256);
+            }
+        }
+    }
+}
+
+TEST_CASE("processBlock doesn't allocate or lock when modes switch", "[realtime]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    AuditedSession session;
+
+    // Hosts only pick up latency changes on a restart, so these are never automated
+    for(auto* id : { "multiRate", "crossoverTopology", "linearPhasePartition", "lfeLimiter" })
+        CHECK_FALSE(session.processor.getValueTreeState().getParameter(id)->isAutomatable());
+
+    for(int i=0; i<60; ++i)
+    {
+        setParameter(session.processor, "crossoverTopology", (float)(i % 3));
+        setParameter(session.processor, "multiRate", (float)((i / 3) % 2));
+        setParameter(session.processor, "linearPhasePartition", (float)((i / 6) % 5));
+        setParameter(session.processor, "lfeBoost", (float)(i % 2));
+        setParameter(session.processor, "crossoverSlope", (float)((i * 7) % numCrossoverSlopes));
+        setParameter(session.processor, "channelDelay" + juce::String(1 + i % 6), (float)(i % 4) * 3.3f);
+        setParameter(session.processor, "channelTrim" + juce::String(1 + i % 6), (float)(i % 3) * -2.0f);
+        setParameter(session.processor, "lfeLimiter", (float)((i / 4) % 2));
+        setParameter(session.processor, "lfeLimiterCeiling", (float)(i % 5) * -2.0f);
+        session.process(300);
+    }
+}
+
+TEST_CASE("processBlock doesn't allocate or lock in any layout", "[realtime]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    for(auto& layout : BassManagementChannelMap::getSupportedLayouts())
+    {
+        AuditedSession session(layout);
+
+        for(int i=0; i<16; ++i)
+        {
+            setParameter(session.processor, "crossoverFrequency", 40.0f + 10.0f * i);
+            session.process(512);
+        }
+    }
+}
+
+TEST_CASE("processBlock doesn't allocate or lock with parallel channel groups", "[realtime]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    auto cores = ScopedMinimumNumCores(4);
+    AuditedSession session(juce::AudioChannelSet::create9point1point6());
+
+    // The workers are started when the host prepares, so the mode isn't automated, and
+    // their jobs are audited too
+    CHECK_FALSE(session.processor.getValueTreeState().getParameter("parallelChannels")->isAutomatable());
+    setParameter(session.processor, "parallelChannels", 1.0f);
+    session.processor.prepareToPlay(48000.0, 4096);
+    REQUIRE(session.processor.getNumChannelGroupWorkers() > 0);
+
+    for(int numSamples : { 4096, 512, 64, 2048, 300 })
+    {
+        setParameter(session.processor, "crossoverFrequency", 40.0f + (float) numSamples / 40.0f);
+        session.process(numSamples);
+        session.process(numSamples);
+    }
+}
+
+TEST_CASE("processBlock doesn't allocate or lock while feeding subwoofers", "[realtime]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    AuditedSession session(juce::AudioChannelSet::create7point1(), 48000.0, 512, BassManagementChannelMap::maxSubwoofers);
+
+    for(int i=0; i<BassManagementChannelMap::maxSubwoofers; ++i)
+    {
+        setParameter(session.processor, "subwooferGain" + juce::String(i + 1), -3.0f * (float) i);
+        setParameter(session.processor, "subwooferInvert" + juce::String(i + 1), (float)(i % 2));
+        setParameter(session.processor, "subwooferDelay" + juce::String(i + 1), 2.5f * (float) i);
+        setParameter(session.processor, "subwooferLowPass" + juce::String(i + 1), 60.0f + 30.0f * (float) i);
+        session.process(512);
+    }
+}
+
+TEST_CASE("processBlock doesn't allocate or lock when the block size changes", "[realtime]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    for(auto sampleRate : { 44100.0, 192000.0 })
+    {
+        AuditedSession session(juce::AudioChannelSet::create5point1(), sampleRate, 512);
+
+        // Including blocks larger than the host promised in prepareToPlay
+        for(auto blockSize : { 1, 17, 256, 511, 512, 1024, 4096, 3 })
+            session.process(blockSize);
+    }
+}
+
+TEST_CASE("processBlock doesn't allocate or lock while an editor is metering", "[realtime]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    for(auto topology : { 0.0f, 1.0f, 2.0f })
+    {
+        AuditedSession session;
+        setParameter(session.processor, "crossoverTopology", topology);
+        session.processor.getMeterSource().setActive(true);
+
+        for(auto blockSize : { 64, 512, 4096 })
+            session.process(blockSize);
+    }
+}
+
+TEST_CASE("processBlock doesn't allocate or lock while profiling and tracing", "[realtime]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    for(auto topology : { 0.0f, 1.0f, 2.0f })
+    {
+        AuditedSession session;
+        setParameter(session.processor, "crossoverTopology", topology);
+        session.processor.getProfiler().setStageTimingEnabled(true);
+        session.processor.getProfiler().setTraceEnabled(true);
+
+        for(auto blockSize : { 64, 512, 4096 })
+            session.process(blockSize);
+    }
+}
+
+TEST_CASE("processBlock doesn't allocate or lock in double precision", "[realtime]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    BassicManagerAudioProcessor processor;
+    processor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+    processor.prepareToPlay(48000.0, 512);
+    processor.getMeterSource().setActive(true);
+
+    juce::AudioBuffer<double> buffer(6, 512);
+    juce::MidiBuffer midi;
+    juce::Random random(12);
+
+    for(int i=0; i<30; ++i)
+    {
+        for(int ch=0; ch<buffer.getNumChannels(); ++ch)
+            for(int n=0; n<buffer.getNumSamples(); ++n)
+                buffer.setSample(ch, n, random.nextFloat() * 2.0 - 1.0);
+
+        setParameter(processor, "crossoverTopology", (float)(i % 3));
+        setParameter(processor, "multiRate", (float)((i / 3) % 2));
+        setParameter(processor, "crossoverFrequency", 40.0f + 5.0f * i);
+
+        RealtimeAudit::resetCounts();
+        processor.processBlock(buffer, midi);
+        auto counts = RealtimeAudit::getCounts();
+
+        CHECK(counts.allocations == 0);
+        CHECK(counts.deallocations == 0);
+        CHECK(counts.lockAcquisitions == 0);
+    }
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+#include <atomic>
+#include <complex>
+#include <thread>
+
+// Measures the plugin's frequency responses with impulses and FFTs, over many
+// settings at once. Settings are measured on every core; the results are
+// plain numbers, so the CHECKs can all be made afterwards on the test's thread
+
+namespace ResponseVerification
+{
+    // One processor configuration, and the input channel the impulse goes into
+    struct Setting
+    {
+        double sampleRate = 48000.0;
+        float crossoverFrequency = 60.0f, lfeLowPassFrequency = 120.0f;
+        CrossoverTopology topology = CrossoverTopology::biquad;
+        CrossoverSlope slope = CrossoverSlope::classic;
+        int inputChannel = BassicManagerAudioProcessor::C;
+        bool doublePrecision = false, multirate = false;
+    };
+
+    // The complex responses from the input channel to itself and to the LFE output
+    struct Response
+    {
+        double binWidth = 0.0;
+        std::vector<std::complex<double>> main, lfe;
+
+        static std::complex<double> at(const std::vector<std::complex<double>>& bins, double binWidth, double frequency)
+        {
+            return bins[(size_t) juce::jlimit(1, (int) bins.size() - 1, juce::roundToInt(frequency / binWidth))];
+        }
+
+        std::complex<double> mainAt(double frequency) const   { return at(main, binWidth, frequency); }
+        std::complex<double> lfeAt(double frequency) const    { return at(lfe, binWidth, frequency); }
+
+        // The exact frequency of the bin that mainAt() and lfeAt() use
+        double binFrequency(double frequency) const
+        {
+            return juce::jlimit(1, (int) main.size() - 1, juce::roundToInt(frequency / binWidth)) * binWidth;
+        }
+    };
+
+    template <typename SampleType>
+    std::vector<std::complex<double>> getSpectrum(const SampleType* impulseResponse, int fftOrder)
+    {
+        juce::dsp::FFT fft(fftOrder);
+        std::vector<float> data((size_t) fft.getSize() * 2, 0.0f);
+        std::transform(impulseResponse, impulseResponse + fft.getSize(), data.begin(), [] (SampleType x) { return (float) x; });
+
+        fft.performRealOnlyForwardTransform(data.data(), true);
+
+        std::vector<std::complex<double>> bins((size_t) fft.getSize() / 2 + 1);
+
+        for(size_t k=0; k<bins.size(); ++k)
+            bins[k] = { data[2 * k], data[2 * k + 1] };
+
+        return bins;
+    }
+
+    template <typename SampleType>
+    Response measure(juce::AudioProcessor& processor, const Setting& setting, int fftOrder)
+    {
+        auto numSamples = 1 << fftOrder;
+        auto blockSize = 512;
+
+        juce::AudioBuffer<SampleType> buffer(6, numSamples);
+        buffer.clear();
+        buffer.setSample(setting.inputChannel, 0, SampleType(1));
+
+        juce::MidiBuffer midiBuffer;
+        juce::AudioBuffer<SampleType> blockBuffer;
+
+        for(int i=0; i<numSamples; i+=blockSize)
+        {
+            blockBuffer.setDataToReferTo(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), i, std::min(blockSize, numSamples-i));
+            processor.processBlock(blockBuffer, midiBuffer);
+        }
+
+        Response response;
+        response.binWidth = setting.sampleRate / numSamples;
+        response.main = getSpectrum(buffer.getReadPointer(setting.inputChannel), fftOrder);
+        response.lfe = getSpectrum(buffer.getReadPointer(BassicManagerAudioProcessor::LFE), fftOrder);
+        return response;
+    }
+
+    // Runs an impulse through a freshly prepared processor. The impulse response is at
+    // least 0.65 s long, plenty for the slowest crossover to ring out
+    inline Response measure(const Setting& setting)
+    {
+        BassicManagerAudioProcessor processor;
+        setParameter(processor, "crossoverFrequency", setting.crossoverFrequency);
+        setParameter(processor, "lfeLowPassFrequency", setting.lfeLowPassFrequency);
+        setParameter(processor, "crossoverTopology", (float) setting.topology);
+        setParameter(processor, "crossoverSlope", (float) setting.slope);
+        setParameter(processor, "multiRate", setting.multirate ? 1.0f : 0.0f);
+
+        if(setting.doublePrecision)
+            processor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+
+        processor.prepareToPlay(setting.sampleRate, 512);
+
+        auto fftOrder = (int) std::ceil(std::log2(setting.sampleRate * 0.65));
+
+        return setting.doublePrecision ? measure<double>(processor, setting, fftOrder)
+                                       : measure<float>(processor, setting, fftOrder);
+    }
+
+    // Maps every setting to a result on all cores, keeping the settings' order
+    template <typename Result, typename Function>
+    std::vector<Result> forEachInParallel(const std::vector<Setting>& settings, Function&& function)
+    {
+        std::vector<Result> results(settings.size());
+        std::atomic<size_t> nextSetting { 0 };
+
+        auto worker = [&]
+        {
+            for(auto index = nextSetting++; index < settings.size(); index = nextSetting++)
+                results[index] = function(settings[index]);
+        };
+
+        std::vector<std::thread> threads;
+        auto numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+        for(unsigned i=1; i<numThreads; ++i)
+            threads.emplace_back(worker);
+
+        worker();
+
+        for(auto& thread : threads)
+            thread.join();
+
+        return results;
+    }
+
+    // The designed response of one side of the crossover, in double precision
+    inline std::complex<double> getDesignedResponse(CrossoverSlope slope, bool isHighPass, double sampleRate, double crossover, double frequency)
+    {
+        std::vector<CrossoverCoefficientTable<double>::Section> sections;
+        CrossoverCoefficientTable<double>::design(slope, isHighPass, sampleRate, crossover, sections);
+
+        auto z = std::polar(1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate);
+        std::complex<double> response(1.0);
+
+        for(auto& s : sections)
+            response *= (s.b0 + s.b1 * z + s.b2 * z * z) / (1.0 + s.a1 * z + s.a2 * z * z);
+
+        return response;
+    }
+
+    inline double toDecibels(std::complex<double> value)
+    {
+        return 20.0 * std::log10(std::max(std::abs(value), 1.0e-12));
+    }
+
+    // Angle between two responses in degrees, -180 to 180
+    inline double getPhaseDifference(std::complex<double> a, std::complex<double> b)
+    {
+        return juce::radiansToDegrees(std::arg(a / b));
+    }
+}
@@ -0,0 +1,128 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+// Idle channels skip their filters; that must be inaudible, and must actually happen
+
+static void fillNoise(juce::AudioBuffer<float>& buffer, juce::Random& random)
+{
+    for(int ch=0; ch<buffer.getNumChannels(); ++ch)
+        for(int i=0; i<buffer.getNumSamples(); ++i)
+            buffer.setSample(ch, i, random.nextFloat() - 0.5f);
+}
+
+TEST_CASE("Filtering a list of channels matches filtering all of them", "[silence]") {
+    const int numChannels = 6;
+    const int numSamples = 700;
+    const int active[] = { 0, 2, 5 };
+
+    juce::Random random(1);
+    juce::AudioBuffer<float> all(numChannels, numSamples), some(numChannels, numSamples);
+    fillNoise(all, random);
+    some.makeCopyOf(all);
+
+    MultichannelBiquadCascade<float> biquadAll, biquadSome;
+    TPTHighPassCascade<float> tptAll, tptSome;
+    auto highPass = juce::dsp::IIR::Coefficients<float>::makeFirstOrderHighPass(48000.0, 80.0f);
+
+    for(auto* cascade : { &biquadAll, &biquadSome })
+    {
+        cascade->prepare(numChannels, 4, 256);
+
+        for(int section=0; section<4; ++section)
+            cascade->setSection(section, *highPass);
+    }
+
+    for(auto* cascade : { &tptAll, &tptSome })
+    {
+        cascade->prepare(48000.0, numChannels, 4, 256, 0.02);
+        cascade->setCutoffFrequency(80.0f);
+        cascade->reset();
+    }
+
+    biquadAll.process(all.getArrayOfWritePointers(), numSamples);
+    tptAll.process(all.getArrayOfWritePointers(), numSamples);
+    biquadSome.process(some.getArrayOfWritePointers(), active, 3, numSamples);
+    tptSome.process(some.getArrayOfWritePointers(), active, 3, numSamples);
+
+    juce::AudioBuffer<float> original(numChannels, numSamples);
+    juce::Random sameRandom(1);
+    fillNoise(original, sameRandom);
+
+    for(int ch=0; ch<numChannels; ++ch)
+    {
+        auto isActive = std::find(std::begin(active), std::end(active), ch) != std::end(active);
+        auto& expected = isActive ? all : original;
+
+        for(int i=0; i<numSamples; ++i)
+            CHECK(some.getSample(ch, i) == Approx(expected.getSample(ch, i)).margin(1.0e-6));
+
+        CHECK(biquadSome.isChannelStateBelow(ch, 1.0e-9f) == ! isActive);
+        CHECK(tptSome.isChannelStateBelow(ch, 1.0e-9f) == ! isActive);
+    }
+}
+
+TEST_CASE("A C-only stem resumes after silence exactly like a fresh start", "[silence]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    const double sampleRate = 48000.0;
+    const int blockSize = 512;
+    const int burstLength = 24000;
+    const int resumeAt = 192 * blockSize;   // two seconds in, long enough for every path to go idle
+    const int totalLength = resumeAt + burstLength;
+
+    for(int topology : { 0, 1 })
+    {
+        for(float multiRate : { 0.0f, 1.0f })
+        {
+            BassicManagerAudioProcessor streaming, fresh;
+
+            for(auto* processor : { &streaming, &fresh })
+            {
+                setParameter(*processor, "crossoverTopology", (float)topology);
+                setParameter(*processor, "multiRate", multiRate);
+                processor->prepareToPlay(sampleRate, blockSize);
+            }
+
+            // A dialog-like stem: only the centre channel, a burst, silence, then another burst
+            juce::AudioBuffer<float> stem(6, totalLength), resumed(6, burstLength);
+            stem.clear();
+            resumed.clear();
+            juce::Random random(2);
+
+            for(int i=0; i<burstLength; ++i)
+            {
+                auto sample = 0.5f * (random.nextFloat() - 0.5f);
+                stem.setSample(BassicManagerAudioProcessor::C, i, sample);
+                stem.setSample(BassicManagerAudioProcessor::C, resumeAt + i, sample);
+                resumed.setSample(BassicManagerAudioProcessor::C, i, sample);
+            }
+
+            processInBlocks(streaming, stem, blockSize);
+            processInBlocks(fresh, resumed, blockSize);
+
+            // Skipping left (almost) zero state behind, so the second burst comes out as if nothing preceded it
+            for(int ch=0; ch<6; ++ch)
+                for(int i=0; i<burstLength; ++i)
+                    CHECK(stem.getSample(ch, resumeAt + i) == Approx(resumed.getSample(ch, i)).margin(1.0e-4));
+
+            // Five silent mains throughout, and everything idle for most of the gap
+            CHECK(streaming.getSilenceSkipRate() > 0.6);
+            CHECK(fresh.getSilenceSkipRate() > 0.4);
+        }
+    }
+}
+
+TEST_CASE("Signal on every channel is never skipped", "[silence]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    BassicManagerAudioProcessor processor;
+    processor.prepareToPlay(48000.0, 512);
+
+    juce::Random random(3);
+    juce::AudioBuffer<float> buffer(6, 48000);
+    fillNoise(buffer, random);
+
+    processInBlocks(processor, buffer, 512);
+    CHECK(processor.getSilenceSkipRate() == 0.0);
+}
@@ -0,0 +1,105 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+// Every speaker can be delayed and trimmed on its own, without touching the others
+
+namespace
+{
+    // Runs a buffer through in lengths of 1 to tileSize samples, so the writes land at every offset into the lines
+    void processUnevenly(SpeakerAlignment<double>& alignment, juce::AudioBuffer<double>& buffer, int tileSize)
+    {
+        for(int start=0; start<buffer.getNumSamples();)
+        {
+            auto length = std::min(1 + (start * 7) % tileSize, buffer.getNumSamples() - start);
+            alignment.process(buffer.getArrayOfWritePointers(), start, length);
+            start += length;
+        }
+    }
+}
+
+TEST_CASE("A whole-sample delay is exact", "[speakerAlignment]") {
+    const int numSamples = 5000;
+    const int tileSize = 64;
+
+    SpeakerAlignment<double> alignment;
+    alignment.prepare(48000.0, 2, tileSize);
+    CHECK_FALSE(alignment.isActive());
+
+    alignment.setDelay(0, 237.0);
+    CHECK(alignment.isActive());
+
+    juce::Random random(1);
+    juce::AudioBuffer<double> buffer(2, numSamples), input(2, numSamples);
+
+    for(int ch=0; ch<2; ++ch)
+        for(int i=0; i<numSamples; ++i)
+            input.setSample(ch, i, random.nextDouble() * 2.0 - 1.0);
+
+    buffer.makeCopyOf(input);
+    processUnevenly(alignment, buffer, tileSize);
+
+    for(int i=0; i<numSamples; ++i)
+    {
+        CHECK(buffer.getSample(0, i) == (i < 237 ? 0.0 : input.getSample(0, i - 237)));
+        CHECK(buffer.getSample(1, i) == input.getSample(1, i));
+    }
+}
+
+TEST_CASE("A fractional delay shifts a sine by the fraction", "[speakerAlignment]") {
+    const double sampleRate = 48000.0;
+    const double frequency = 1000.0;
+    const int numSamples = 4000;
+
+    for(double delay : { 0.3, 1.5, 10.25, 480.9 })
+    {
+        SpeakerAlignment<double> alignment;
+        alignment.prepare(sampleRate, 1, 64);
+        alignment.setDelay(0, delay);
+
+        juce::AudioBuffer<double> buffer(1, numSamples);
+
+        for(int i=0; i<numSamples; ++i)
+            buffer.setSample(0, i, std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate));
+
+        processUnevenly(alignment, buffer, 64);
+
+        // A four-tap Lagrange interpolator is good to about -70 dB at this frequency
+        for(int i=1000; i<numSamples; ++i)
+            CHECK(buffer.getSample(0, i) == Approx(std::sin(juce::MathConstants<double>::twoPi * frequency * (i - delay) / sampleRate)).margin(3.0e-4));
+    }
+}
+
+TEST_CASE("Delays and trims reach the right output channels", "[speakerAlignment]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    const double sampleRate = 48000.0;
+    const int blockSize = 500;
+    const int numSamples = 4800;
+
+    BassicManagerAudioProcessor processor;
+    setParameter(processor, "channelDelay1", 2.0f);
+    setParameter(processor, "channelTrim1", -6.0f);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    // An impulse on the left main, well above the crossover once high-passed
+    juce::AudioBuffer<float> buffer(6, numSamples);
+    buffer.clear();
+    buffer.setSample(BassicManagerAudioProcessor::L, 100, 1.0f);
+    buffer.setSample(BassicManagerAudioProcessor::R, 100, 1.0f);
+
+    processInBlocks(processor, buffer, blockSize);
+
+    // The high-passed impulse peaks at once, so the delayed one peaks 96 samples later
+    auto peak = [&buffer](int channel)
+    {
+        auto* data = buffer.getReadPointer(channel);
+        return (int)(std::max_element(data, data + numSamples, [](float a, float b) { return std::abs(a) < std::abs(b); }) - data);
+    };
+
+    CHECK(peak(BassicManagerAudioProcessor::L) == 196);
+    CHECK(peak(BassicManagerAudioProcessor::R) == 100);
+
+    auto level = [&buffer](int channel) { return std::abs(buffer.getSample(channel, channel == BassicManagerAudioProcessor::L ? 196 : 100)); };
+    CHECK(juce::Decibels::gainToDecibels(level(BassicManagerAudioProcessor::L) / level(BassicManagerAudioProcessor::R)) == Approx(-6.0f).margin(0.01));
+}
@@ -0,0 +1,114 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+// Sessions recall from the binary state, and still from the XML ones saved before it
+
+namespace
+{
+    float getParameterValue(juce::AudioProcessor& processor, const juce::String& parameterID)
+    {
+        for(auto* parameter : processor.getParameters())
+            if(auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+                if(ranged->paramID == parameterID)
+                    return ranged->convertFrom0to1(ranged->getValue());
+
+        FAIL("Unknown parameter " << parameterID);
+        return 0.0f;
+    }
+
+    void setSessionParameters(juce::AudioProcessor& processor)
+    {
+        setParameter(processor, "crossoverFrequency", 95.0f);
+        setParameter(processor, "lfeBoost", 1.0f);
+        setParameter(processor, "crossoverSlope", 6.0f);
+        setParameter(processor, "channelDelay3", 12.5f);
+        setParameter(processor, "subwooferInvert2", 1.0f);
+    }
+
+    void checkSessionParameters(juce::AudioProcessor& processor)
+    {
+        CHECK(getParameterValue(processor, "crossoverFrequency") == Approx(95.0f).margin(1.0e-3));
+        CHECK(getParameterValue(processor, "lfeBoost") == 1.0f);
+        CHECK(getParameterValue(processor, "crossoverSlope") == Approx(6.0f).margin(1.0e-3));
+        CHECK(getParameterValue(processor, "channelDelay3") == Approx(12.5f).margin(1.0e-3));
+        CHECK(getParameterValue(processor, "subwooferInvert2") == 1.0f);
+        CHECK(getParameterValue(processor, "lfeLowPassFrequency") == Approx(120.0f).margin(1.0e-3));
+    }
+}
+
+TEST_CASE("The binary state recalls every parameter", "[state]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    BassicManagerAudioProcessor saved;
+    setSessionParameters(saved);
+
+    juce::MemoryBlock state;
+    saved.getStateInformation(state);
+
+    CHECK(BinaryParameterState::isBinaryState(state.getData(), (int) state.getSize()));
+    CHECK((int) state.getSize() == BinaryParameterState::headerSize + (int) saved.getParameters().size() * (int) sizeof(float));
+
+    BassicManagerAudioProcessor recalled;
+    recalled.setStateInformation(state.getData(), (int) state.getSize());
+    checkSessionParameters(recalled);
+
+    // Straight into the snapshot the audio thread reads
+    ParameterSnapshot snapshot(recalled.getValueTreeState());
+    CHECK(snapshot.update().crossoverFrequency == Approx(95.0f).margin(1.0e-3));
+    CHECK(snapshot.update().slope == CrossoverSlope::butterworth4);
+}
+
+TEST_CASE("XML states saved by earlier versions still recall", "[state]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    BassicManagerAudioProcessor saved;
+    setSessionParameters(saved);
+
+    // As the old getStateInformation wrote it, under the tree's old name
+    auto xml = saved.getValueTreeState().copyState().createXml();
+    xml->setTagName("APVTSTutorial");
+
+    juce::MemoryBlock state;
+    juce::AudioProcessor::copyXmlToBinary(*xml, state);
+    CHECK_FALSE(BinaryParameterState::isBinaryState(state.getData(), (int) state.getSize()));
+
+    BassicManagerAudioProcessor recalled;
+    recalled.setStateInformation(state.getData(), (int) state.getSize());
+    checkSessionParameters(recalled);
+}
+
+TEST_CASE("Binary states from other builds", "[state]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    BassicManagerAudioProcessor saved;
+    setSessionParameters(saved);
+
+    juce::MemoryBlock state;
+    saved.getStateInformation(state);
+
+    // An older build knew fewer parameters; the ones it didn't know go back to their defaults
+    {
+        BassicManagerAudioProcessor recalled;
+        setParameter(recalled, "subwooferLowPass4", 80.0f);
+
+        auto* words = static_cast<juce::uint32*>(state.getData());
+        auto numValues = words[2];
+        words[2] = 3;
+        recalled.setStateInformation(state.getData(), BinaryParameterState::headerSize + 3 * (int) sizeof(float));
+        words[2] = numValues;
+
+        CHECK(getParameterValue(recalled, "crossoverFrequency") == Approx(95.0f).margin(1.0e-3));
+        CHECK(getParameterValue(recalled, "lfeBoost") == 1.0f);
+        CHECK(getParameterValue(recalled, "crossoverSlope") == 0.0f);
+        CHECK(getParameterValue(recalled, "subwooferLowPass4") == Approx(250.0f).margin(1.0e-3));
+    }
+
+    // Truncated data, and a format this build doesn't know, change nothing
+    {
+        BassicManagerAudioProcessor recalled;
+        recalled.setStateInformation(state.getData(), (int) state.getSize() - 1);
+        CHECK(getParameterValue(recalled, "crossoverFrequency") == Approx(60.0f).margin(1.0e-3));
+
+        static_cast<juce::uint32*>(state.getData())[1] = BinaryParameterState::currentVersion + 1;
+        recalled.setStateInformation(state.getData(), (int) state.getSize());
+        CHECK(getParameterValue(recalled, "crossoverFrequency") == Approx(60.0f).margin(1.0e-3));
+    }
+}
@@ -0,0 +1,99 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+// A bass tone and a tone well above the crossover on every channel
+static void fillTwoTones(juce::AudioBuffer<float>& buffer, double sampleRate)
+{
+    for(int ch=0; ch<buffer.getNumChannels(); ++ch)
+    {
+        auto samples = buffer.getWritePointer(ch);
+        auto gain = 0.1f * (float)(ch+1);
+
+        for(int i=0; i<buffer.getNumSamples(); ++i)
+        {
+            auto t = (double)i / sampleRate;
+            samples[i] = gain * (float)(std::sin(juce::MathConstants<double>::twoPi * 45.0 * t)
+                                        + 0.5 * std::sin(juce::MathConstants<double>::twoPi * 1500.0 * t));
+        }
+    }
+}
+
+TEST_CASE("State-variable crossover matches the biquad crossover", "[stateVariable]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    for(auto sampleRate : { 44100.0, 96000.0, 192000.0 })
+    {
+        for(auto multiRate : { 0.0f, 1.0f })
+        {
+            int blockSize = 333;
+            int lengthInSamples = (int)sampleRate / 2;
+
+            BassicManagerAudioProcessor biquad, stateVariable;
+            setParameter(biquad, "multiRate", multiRate);
+            setParameter(stateVariable, "multiRate", multiRate);
+            setParameter(stateVariable, "crossoverTopology", 1.0f);
+
+            biquad.prepareToPlay(sampleRate, blockSize);
+            stateVariable.prepareToPlay(sampleRate, blockSize);
+
+            juce::AudioBuffer<float> expected(6, lengthInSamples), actual(6, lengthInSamples);
+            fillTwoTones(expected, sampleRate);
+            fillTwoTones(actual, sampleRate);
+
+            processInBlocks(biquad, expected, blockSize);
+            processInBlocks(stateVariable, actual, blockSize);
+
+            for(int ch=0; ch<6; ++ch)
+            {
+                double error = 0.0, signal = 0.0;
+
+                for(int i=0; i<lengthInSamples; ++i)
+                {
+                    auto difference = actual.getSample(ch, i) - expected.getSample(ch, i);
+                    error += difference * difference;
+                    signal += expected.getSample(ch, i) * expected.getSample(ch, i);
+                }
+
+                CHECK(10.0 * std::log10(error / signal) < -60.0);
+            }
+        }
+    }
+}
+
+TEST_CASE("State-variable crossover stays stable under fast automation", "[stateVariable]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    double sampleRate = 48000.0;
+    int blockSize = 7;
+    int lengthInSamples = 48000;
+
+    BassicManagerAudioProcessor processor;
+    setParameter(processor, "crossoverTopology", 1.0f);
+    processor.prepareToPlay(sampleRate, 512);
+
+    juce::AudioBuffer<float> buffer(6, lengthInSamples);
+    fillTwoTones(buffer, sampleRate);
+
+    juce::Random random(42);
+    juce::MidiBuffer midi;
+    juce::AudioBuffer<float> block;
+
+    // Jump both cutoffs across their whole range every few samples
+    for(int start=0; start<lengthInSamples; start+=blockSize)
+    {
+        setParameter(processor, "crossoverFrequency", 20.0f + 230.0f * random.nextFloat());
+        setParameter(processor, "lfeLowPassFrequency", 20.0f + 230.0f * random.nextFloat());
+
+        auto num = juce::jmin(blockSize, lengthInSamples - start);
+        block.setDataToReferTo(buffer.getArrayOfWritePointers(), 6, start, num);
+        processor.processBlock(block, midi);
+    }
+
+    for(int ch=0; ch<6; ++ch)
+    {
+        auto samples = buffer.getReadPointer(ch);
+        CHECK(std::all_of(samples, samples + lengthInSamples, [](float s) { return std::isfinite(s); }));
+        CHECK(buffer.getMagnitude(ch, 0, lengthInSamples) < 5.0f);
+    }
+}
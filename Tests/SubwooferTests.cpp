@@ -0,0 +1,126 @@
+#include "catch2/catch.hpp"
+#include <PluginProcessor.h>
+#include "TestHelpers.h"
+
+// The optional subwoofer bus gives every sub its own copy of the bass, tuned on its own
+
+TEST_CASE("Subwoofer bus layouts", "[subwoofers]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+    BassicManagerAudioProcessor processor;
+
+    for(int numSubwoofers=0; numSubwoofers<=BassManagementChannelMap::maxSubwoofers; ++numSubwoofers)
+        CHECK(processor.setBusesLayout(BassicManagerAudioProcessor::makeBusesLayout(juce::AudioChannelSet::create7point1(), numSubwoofers)));
+
+    auto buses = BassicManagerAudioProcessor::makeBusesLayout(juce::AudioChannelSet::create5point1());
+    buses.outputBuses.getReference(1) = juce::AudioChannelSet::mono();
+    CHECK(processor.setBusesLayout(buses));
+
+    CHECK_FALSE(processor.setBusesLayout(BassicManagerAudioProcessor::makeBusesLayout(juce::AudioChannelSet::create5point1(), BassManagementChannelMap::maxSubwoofers + 1)));
+}
+
+TEST_CASE("Subwoofer bank matches separate filter chains", "[subwoofers]") {
+    const double sampleRate = 48000.0;
+    const int numSamples = 2000;
+    const int tileSize = 64;
+
+    // More subs than lanes too, so a second register is used
+    for(int numSubwoofers : { 1, 2, 3, 4, 9 })
+    {
+        SubwooferBank<double> bank;
+        bank.prepare(sampleRate, numSubwoofers, tileSize);
+
+        std::vector<std::vector<juce::dsp::IIR::Filter<double>>> expectedFilters;
+        std::vector<double> gains;
+
+        for(int sub=0; sub<numSubwoofers; ++sub)
+        {
+            auto frequency = 40.0 + 25.0 * sub;
+            auto coefficients = juce::dsp::IIR::Coefficients<double>::makeLowPass(sampleRate, frequency);
+            expectedFilters.push_back({ juce::dsp::IIR::Filter<double>(coefficients), juce::dsp::IIR::Filter<double>(coefficients) });
+            gains.push_back(sub % 2 == 0 ? 0.5 + sub : -1.0);
+
+            bank.setLowPassFrequency(sub, frequency);
+            bank.setGain(sub, gains.back());
+        }
+
+        bank.reset();
+
+        juce::Random random(numSubwoofers);
+        std::vector<double> bass((size_t) numSamples);
+
+        for(auto& sample : bass)
+            sample = random.nextDouble() * 2.0 - 1.0;
+
+        juce::AudioBuffer<double> outputs(numSubwoofers, numSamples);
+
+        for(int start=0; start<numSamples; start+=tileSize)
+            bank.process(bass.data() + start, outputs.getArrayOfWritePointers(), start, std::min(tileSize, numSamples - start));
+
+        double maxError = 0.0;
+
+        for(int sub=0; sub<numSubwoofers; ++sub)
+        {
+            for(int i=0; i<numSamples; ++i)
+            {
+                auto expected = bass[(size_t) i];
+
+                for(auto& filter : expectedFilters[(size_t) sub])
+                    expected = filter.processSample(expected);
+
+                maxError = std::max(maxError, std::abs(outputs.getSample(sub, i) - expected * gains[(size_t) sub]));
+            }
+        }
+
+        CHECK(maxError < 1.0e-9);
+    }
+}
+
+TEST_CASE("Every subwoofer feed is the LFE output with its own gain, polarity, delay and low-pass", "[subwoofers]") {
+    auto gui = juce::ScopedJuceInitialiser_GUI {};
+
+    const double sampleRate = 48000.0;
+    const int blockSize = 500;
+    const int numSamples = 9600;
+    const int numSubwoofers = 3;
+
+    BassicManagerAudioProcessor processor;
+    REQUIRE(processor.setBusesLayout(BassicManagerAudioProcessor::makeBusesLayout(juce::AudioChannelSet::create5point1(), numSubwoofers)));
+    setParameter(processor, "subwooferGain1", -6.0f);
+    setParameter(processor, "subwooferInvert2", 1.0f);
+    setParameter(processor, "subwooferDelay2", 1.0f);
+    setParameter(processor, "subwooferLowPass3", 50.0f);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    juce::AudioBuffer<float> buffer(6 + numSubwoofers, numSamples);
+    buffer.clear();
+    juce::Random random(5);
+
+    for(int ch=0; ch<6; ++ch)
+        for(int i=0; i<numSamples; ++i)
+            buffer.setSample(ch, i, random.nextFloat() - 0.5f);
+
+    processInBlocks(processor, buffer, blockSize);
+
+    const float gains[] = { juce::Decibels::decibelsToGain(-6.0f), -1.0f, 1.0f };
+    const int delays[] = { 0, 48, 0 };
+    const double cutoffs[] = { 250.0, 250.0, 50.0 };
+
+    double maxError = 0.0;
+
+    for(int sub=0; sub<numSubwoofers; ++sub)
+    {
+        auto coefficients = juce::dsp::IIR::Coefficients<double>::makeLowPass(sampleRate, cutoffs[sub]);
+        juce::dsp::IIR::Filter<double> first(coefficients), second(coefficients);
+
+        for(int i=0; i<numSamples; ++i)
+        {
+            auto expected = second.processSample(first.processSample((double) buffer.getSample(BassicManagerAudioProcessor::LFE, i)));
+            auto delayed = i + delays[sub];
+
+            if(delayed < numSamples)
+                maxError = std::max(maxError, std::abs(buffer.getSample(6 + sub, delayed) - expected * gains[sub]));
+        }
+    }
+
+    CHECK(maxError < 1.0e-5);
+}
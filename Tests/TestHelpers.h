@@ -0,0 +1,46 @@
+#pragma once
+
+#include "catch2/catch.hpp"
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <RealtimeWorkerPool.h>
+
+// Sets a plugin parameter by ID, in its natural (unnormalised) range
+inline void setParameter(juce::AudioProcessor& processor, const juce::String& parameterID, float value)
+{
+    for(auto* parameter : processor.getParameters())
+    {
+        if(auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+        {
+            if(ranged->paramID == parameterID)
+            {
+                ranged->setValueNotifyingHost(ranged->convertTo0to1(value));
+                return;
+            }
+        }
+    }
+
+    FAIL("Unknown parameter " << parameterID);
+}
+
+// Runs a whole buffer through the plugin in host-sized blocks
+inline void processInBlocks(juce::AudioProcessor& processor, juce::AudioBuffer<float>& buffer, int blockSize)
+{
+    juce::MidiBuffer midiBuffer;
+    juce::AudioBuffer<float> blockBuffer;
+
+    for(int i=0; i<buffer.getNumSamples(); i+=blockSize)
+    {
+        auto subBlockSize = std::min(blockSize, buffer.getNumSamples()-i);
+        blockBuffer.setDataToReferTo(buffer.getArrayOfWritePointers(), buffer.getNumChannels(), i, subBlockSize);
+
+        processor.processBlock(blockBuffer, midiBuffer);
+    }
+}
+
+// Starts channel-group workers as if the machine had at least numCores cores, so the
+// parallel path runs however few this one has
+struct ScopedMinimumNumCores
+{
+    explicit ScopedMinimumNumCores(int numCores)   { RealtimeWorkerPool::minimumNumCoresForTesting = numCores; }
+    ~ScopedMinimumNumCores()                       { RealtimeWorkerPool::minimumNumCoresForTesting = 0; }
+};